@@ -0,0 +1,414 @@
+// gen_bench.cpp
+// Generates large synthetic assembly programs for benchmarking GenA.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Used libraries.
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+
+// Used constants.
+const char *ISA_FLAG = "-i";
+const char *OUT_FLAG = "-o";
+const char *LINES_FLAG = "-n";
+const char *DEPTH_FLAG = "-d";
+const char *FANOUT_FLAG = "-b";
+const char *REGISTER_FLAG = "-r";
+const char *SEED_FLAG = "-s";
+const char *EXCLUDE_FLAG = "-x";
+const std::string COMMENT = ";";
+const std::string RELAX = ".relax";
+const std::string ISA_NAME = "isa.txt";
+const std::string ENTRY_NAME = "main.s";
+const std::string INCLUDE_PREFIX = "inc_";
+const std::string ASM_EXTENSION = ".s";
+const std::string SYM_TOKEN = "Sym";
+const std::string VAL_TOKEN = "Val";
+const std::string PC_TOKEN = "$Val";
+const size_t DEFAULT_LINES = 100000;
+const size_t DEFAULT_DEPTH = 3;
+const size_t DEFAULT_FANOUT = 3;
+const unsigned DEFAULT_SEED = 1;
+// The non comment lines at the start of an ISA file before its code macros.
+const size_t ISA_HEADER_LINES = 4;
+const size_t FUNC_PATH_LINE = 0;
+const size_t WORD_SIZE_LINE = 1;
+const size_t MEM_SIZE_LINE = 2;
+const size_t STYLE_LINE = 3;
+// How often the other kinds of lines are generated, in lines.
+const size_t ORG_INTERVAL = 997;
+const size_t DATA_INTERVAL = 499;
+const size_t LABEL_INTERVAL = 4;
+// The most words an .org skips and a variable takes.
+const size_t MAX_ORG_GAP = 64;
+const size_t MAX_DATA_WORDS = 4;
+// How far ahead of the last defined label references reach.
+const size_t FORWARD_LABELS = 64;
+const size_t MAX_NUMBER = 16;
+const size_t NUM_REGISTERS = 32;
+// The memory sizes written are this many times the memory used.
+const size_t MEMORY_SLACK = 2;
+
+// A code macro of the ISA, as its name, operand template and size.
+struct bench_macro {
+    std::string name;
+    std::vector<std::string> tokens;
+    size_t num_bits;
+};
+
+// The state of the program being generated.
+struct bench_state {
+    std::vector<bench_macro> macros;
+    // The elements of the style line, as their names and delimiters.
+    std::vector<std::pair<std::string, std::string>> style;
+    std::filesystem::path out_dir;
+    size_t word_bits;
+    bool harvard;
+    bool registers;
+    size_t lines_per_file;
+    size_t max_depth;
+    size_t fanout;
+    std::mt19937 rng;
+    size_t num_files;
+    size_t next_macro;
+    size_t num_labels;
+    size_t max_label_ref;
+    size_t num_vars;
+    size_t pc_bits;
+    size_t max_pc_bits;
+    size_t data_words;
+    size_t total_lines;
+};
+
+// Helper functions.
+
+// Displays a usage error message.
+void usageError(char *prog) {
+    std::cerr << "\nUsage: " << prog << " [options]" << std::endl << "\n" \
+    << "Options:\n" \
+    << "\t-i <ISA file path>\n" \
+    << "\t\tSpecify the ISA to generate a program for (required).\n" \
+    << "\t-o <output directory>\n" \
+    << "\t\tSpecify the directory the program is written to (required).\n" \
+    << "\t-n <lines>\n" \
+    << "\t\tSpecify the number of lines to generate.\n" \
+    << "\t-d <depth>\n" \
+    << "\t\tSpecify the depth of the include tree.\n" \
+    << "\t-b <fanout>\n" \
+    << "\t\tSpecify the number of files each file includes.\n" \
+    << "\t-r\n" \
+    << "\t\tUse registers as well as numbers and labels for values.\n" \
+    << "\t-s <seed>\n" \
+    << "\t\tSpecify the seed of the random choices.\n" \
+    << "\t-x <operation name>\n" \
+    << "\t\tSkip every code macro of an operation, may be repeated.\n" \
+    << std::endl;
+}
+
+// Splits a line by whitespace.
+std::vector<std::string> split(const std::string& line) {
+    std::istringstream stream(line);
+    std::vector<std::string> words;
+    std::string word;
+    while (stream >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+// Returns the user function path of an ISA absolute. Paths that do not exist
+// are looked for next to the ISA file, so ISAs written on other machines can
+// be used.
+std::string resolve_function_path(const std::string& path, \
+                                  const std::filesystem::path& isa_path) {
+    std::filesystem::path func_path(path);
+    if (!std::filesystem::exists(func_path)) {
+        func_path = isa_path.parent_path() / func_path.filename();
+    }
+    return std::filesystem::absolute(func_path).lexically_normal().string();
+}
+
+// Returns a value for a value slot of an operand. Branches only target labels.
+std::string make_value(bench_state& state, bool branch) {
+    size_t kind = branch ? 0 : (state.rng() % (state.registers ? 4 : 3));
+    // Labels are taken from before and after the last label defined.
+    if (kind == 0) {
+        size_t label = state.rng() % (state.num_labels + FORWARD_LABELS);
+        state.max_label_ref = std::max(state.max_label_ref, label + 1);
+        return "l" + std::to_string(label);
+    }
+    if ((kind == 1) && (state.num_vars > 0)) {
+        return "v" + std::to_string(state.rng() % state.num_vars);
+    }
+    if (kind == 3) {
+        return "r" + std::to_string(state.rng() % NUM_REGISTERS);
+    }
+    return std::to_string(state.rng() % MAX_NUMBER);
+}
+
+// Returns a line in the style of the ISA from its elements. Elements that are
+// empty are left out.
+std::string make_line(const bench_state& state, const std::string& label, \
+                      const std::string& op_name, const std::string& operand) {
+    std::string line;
+    for (const auto& element : state.style) {
+        const std::string& text = (element.first == "label") ? label : \
+                                  (element.first == "op_name") ? op_name : \
+                                  operand;
+        if (!text.empty()) {
+            if (!line.empty() && (line.back() != ' ')) {
+                line += ' ';
+            }
+            line += text + element.second;
+        }
+    }
+    return line;
+}
+
+// Writes the next instruction, with a label if one is given.
+void write_instruction(bench_state& state, std::ostream& out, \
+                       const std::string& label) {
+    const bench_macro& macro = \
+        state.macros.at(state.next_macro++ % state.macros.size());
+    std::string operand;
+    // Operations with a program counter slot are relative branches.
+    bool branch = (std::find(macro.tokens.begin(), macro.tokens.end(), \
+                   PC_TOKEN) != macro.tokens.end());
+    for (const std::string& token : macro.tokens) {
+        if (token == VAL_TOKEN) {
+            operand += make_value(state, branch);
+        }
+        // The program counter slot is filled in by the assembler.
+        else if (token.compare(0, SYM_TOKEN.length(), SYM_TOKEN) == 0) {
+            operand += token.substr(SYM_TOKEN.length());
+            if (operand.back() == ',') {
+                operand += ' ';
+            }
+        }
+    }
+    out << make_line(state, label, macro.name, operand) << "\n";
+    state.pc_bits += macro.num_bits;
+    state.max_pc_bits = std::max(state.max_pc_bits, state.pc_bits);
+    state.total_lines++;
+}
+
+// Writes a file of the program and the files it includes, in program order so
+// the program counter is known for every line.
+void write_file(bench_state& state, const std::filesystem::path& path, \
+                size_t depth) {
+    std::ofstream out(path);
+    size_t num_children = (depth < state.max_depth) ? state.fanout : 0;
+    size_t next_child = 0;
+
+    if (!out) {
+        std::cerr << "Error: Cannot write file " << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < state.lines_per_file; i++) {
+        // Includes are spread evenly over the file.
+        if ((next_child < num_children) && (i == (next_child + 1) * \
+            state.lines_per_file / (num_children + 1))) {
+            std::filesystem::path child = state.out_dir / \
+                (INCLUDE_PREFIX + std::to_string(state.num_files++) + \
+                 ASM_EXTENSION);
+            out << ".include " << child.string() << "\n";
+            state.total_lines++;
+            write_file(state, child, depth + 1);
+            next_child++;
+        }
+        else if (state.total_lines % ORG_INTERVAL == ORG_INTERVAL - 1) {
+            // Only skip forward so no instructions overlap.
+            size_t org = (state.pc_bits + state.word_bits - 1) / \
+                         state.word_bits + 1 + state.rng() % MAX_ORG_GAP;
+            out << ".org " << org << "\n";
+            state.pc_bits = org * state.word_bits;
+            state.total_lines++;
+        }
+        else if (state.total_lines % DATA_INTERVAL == DATA_INTERVAL - 1) {
+            size_t words = 1 + state.rng() % MAX_DATA_WORDS;
+            out << ".data v" << state.num_vars++ << " " << words << "\n";
+            if (state.harvard) {
+                state.data_words += words;
+            }
+            else {
+                state.pc_bits += words * state.word_bits;
+            }
+            state.total_lines++;
+        }
+        else if (state.total_lines % LABEL_INTERVAL == 0) {
+            write_instruction(state, out, "l" + \
+                              std::to_string(state.num_labels++));
+        }
+        else {
+            write_instruction(state, out, "");
+        }
+    }
+    // The entry file ends by defining every label referenced ahead.
+    if (depth == 0) {
+        while (state.num_labels < state.max_label_ref) {
+            write_instruction(state, out, "l" + \
+                              std::to_string(state.num_labels++));
+        }
+    }
+}
+
+// Main function.
+int main(int argc, char* argv[]) {
+    std::string isa_path;
+    std::string out_dir;
+    std::vector<std::string> excluded;
+    bench_state state = {};
+    size_t num_lines = DEFAULT_LINES;
+    unsigned seed = DEFAULT_SEED;
+
+    state.max_depth = DEFAULT_DEPTH;
+    state.fanout = DEFAULT_FANOUT;
+    for (int i = 1; i < argc; i++) {
+        bool has_value = (i != argc - 1);
+        try {
+            if ((std::strcmp(argv[i], ISA_FLAG) == 0) && has_value) {
+                isa_path = argv[++i];
+            }
+            else if ((std::strcmp(argv[i], OUT_FLAG) == 0) && has_value) {
+                out_dir = argv[++i];
+            }
+            else if ((std::strcmp(argv[i], LINES_FLAG) == 0) && has_value) {
+                num_lines = std::stoul(argv[++i]);
+            }
+            else if ((std::strcmp(argv[i], DEPTH_FLAG) == 0) && has_value) {
+                state.max_depth = std::stoul(argv[++i]);
+            }
+            else if ((std::strcmp(argv[i], FANOUT_FLAG) == 0) && has_value) {
+                state.fanout = std::stoul(argv[++i]);
+            }
+            else if ((std::strcmp(argv[i], SEED_FLAG) == 0) && has_value) {
+                seed = std::stoul(argv[++i]);
+            }
+            else if ((std::strcmp(argv[i], EXCLUDE_FLAG) == 0) && has_value) {
+                excluded.push_back(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], REGISTER_FLAG) == 0) {
+                state.registers = true;
+            }
+            else {
+                usageError(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        catch (const std::exception& e) {
+            usageError(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (isa_path.empty() || out_dir.empty()) {
+        usageError(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    // Read the ISA, keeping its lines to write it again.
+    std::ifstream isa_file(isa_path);
+    std::vector<std::string> isa_lines;
+    std::vector<size_t> header;
+    std::string isa_line;
+    if (!isa_file) {
+        std::cerr << "Error: Unable to open file: " << isa_path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    while (std::getline(isa_file, isa_line)) {
+        if (!isa_line.empty() && (isa_line.find(COMMENT) != 0)) {
+            if (header.size() < ISA_HEADER_LINES) {
+                header.push_back(isa_lines.size());
+            }
+            else {
+                std::vector<std::string> words = split(isa_line);
+                // Name, opcode, template tokens, function and size.
+                // Relaxation lines are copied but are not code macros.
+                if ((words.size() >= 4) && (words.front() != RELAX) && \
+                    (std::find(excluded.begin(), excluded.end(), \
+                               words.front()) == excluded.end())) {
+                    state.macros.push_back({words.front(), \
+                        std::vector<std::string>(words.begin() + 2, \
+                                                 words.end() - 2), \
+                        std::stoul(words.back())});
+                }
+            }
+        }
+        isa_lines.push_back(isa_line);
+    }
+    if ((header.size() < ISA_HEADER_LINES) || state.macros.empty()) {
+        std::cerr << "Error: No code macros in ISA file: " << isa_path \
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::vector<std::string> word_sizes = \
+        split(isa_lines.at(header.at(WORD_SIZE_LINE)));
+    std::vector<std::string> mem_sizes = \
+        split(isa_lines.at(header.at(MEM_SIZE_LINE)));
+    state.word_bits = std::stoul(word_sizes.front());
+    state.harvard = (word_sizes.size() > 1);
+    for (const std::string& element : \
+         split(isa_lines.at(header.at(STYLE_LINE)))) {
+        size_t name_len = element.find_first_not_of( \
+            "abcdefghijklmnopqrstuvwxyz_");
+        if (name_len == std::string::npos) {
+            state.style.push_back({element, " "});
+        }
+        else {
+            state.style.push_back({element.substr(0, name_len), \
+                                   element.substr(name_len)});
+        }
+    }
+
+    // Write the program.
+    state.out_dir = std::filesystem::absolute(out_dir);
+    std::filesystem::create_directories(state.out_dir);
+    state.rng.seed(seed);
+    state.num_files = 1;
+    size_t num_files = 0;
+    size_t level_files = 1;
+    for (size_t depth = 0; depth <= state.max_depth; depth++) {
+        num_files += level_files;
+        level_files *= state.fanout;
+    }
+    state.lines_per_file = std::max<size_t>(num_lines / num_files, 1);
+    write_file(state, state.out_dir / ENTRY_NAME, 0);
+
+    // Write the ISA with an absolute user function path and memory for the
+    // program.
+    size_t prog_words = (state.max_pc_bits + state.word_bits - 1) / \
+                        state.word_bits;
+    mem_sizes.front() = std::to_string(std::max<size_t>( \
+        std::stoul(mem_sizes.front()), prog_words * MEMORY_SLACK));
+    if (state.harvard && (mem_sizes.size() > 1)) {
+        mem_sizes.back() = std::to_string(std::max<size_t>( \
+            std::stoul(mem_sizes.back()), state.data_words * MEMORY_SLACK));
+    }
+    isa_lines.at(header.at(FUNC_PATH_LINE)) = resolve_function_path( \
+        isa_lines.at(header.at(FUNC_PATH_LINE)), isa_path);
+    isa_lines.at(header.at(MEM_SIZE_LINE)) = mem_sizes.front();
+    for (size_t i = 1; i < mem_sizes.size(); i++) {
+        isa_lines.at(header.at(MEM_SIZE_LINE)) += " " + mem_sizes.at(i);
+    }
+    std::ofstream isa_out(state.out_dir / ISA_NAME);
+    for (const std::string& line : isa_lines) {
+        isa_out << line << "\n";
+    }
+    isa_out.close();
+    if (!isa_out) {
+        std::cerr << "Error: Cannot write ISA file in " << out_dir << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::cout << "Generated " << state.total_lines << " lines in " \
+              << state.num_files << " files with " << state.num_labels \
+              << " labels for " << isa_path << " in " << out_dir << "." \
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,256 @@
+// gena_bench.cpp
+// Measures each stage of assembling a program with GenA.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Used libraries.
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <streambuf>
+#include <sys/resource.h>
+#include "assembler.hpp"
+#include "image_writer.hpp"
+#include "lib_cache.hpp"
+#include "isa.hpp"
+#include "source_cache.hpp"
+#include "diagnostics.hpp"
+
+// Used constants.
+const char *FILE_FLAG = "-f";
+const char *ISA_FLAG = "-i";
+const char *OUT_FLAG = "-o";
+const char *CACHE_FLAG = "-c";
+const char *JOBS_FLAG = "-j";
+const char *RUNS_FLAG = "-r";
+const char *LIST_FLAG = "-t";
+const char *DEFAULT_OUTPUT_PATH = "output_bench.hex";
+const char *DEFAULT_CACHE_DIR = ".gena_cache";
+const size_t DEFAULT_RUNS = 5;
+const size_t KB_PER_MB = 1024;
+const int NAME_WIDTH = 20;
+const int TIME_WIDTH = 12;
+const int RATE_WIDTH = 16;
+
+// The stages of assembling a program, in order.
+enum bench_stage {
+    STAGE_ISA_LOAD,
+    STAGE_FIRST_PASS,
+    STAGE_SECOND_PASS,
+    STAGE_OUTPUT,
+    STAGE_LISTING,
+    NUM_STAGES
+};
+const char *STAGE_NAMES[NUM_STAGES] = {"ISA load", "First pass", \
+                                       "Second pass", "Output writing", \
+                                       "Listing writing"};
+
+// Null stream buffer to discard output
+class NullStreamBuf : public std::streambuf {
+protected:
+    virtual int overflow(int c) override {
+        return c; // Discard character
+    }
+};
+
+// Helper functions.
+
+// Displays a usage error message.
+void usageError(char *prog) {
+    std::cerr << "\nUsage: " << prog << " [options]" << std::endl << "\n" \
+    << "Options:\n" \
+    << "\t-f <main file path>\n" \
+    << "\t\tSpecify the main file path (required).\n" \
+    << "\t-i <ISA file path>\n" \
+    << "\t\tSpecify the ISA file path (required).\n" \
+    << "\t-o <output file>\n" \
+    << "\t\tSpecify the output file path.\n" \
+    << "\t-c <cache directory>\n" \
+    << "\t\tSpecify the ISA user library cache directory.\n" \
+    << "\t-j <jobs>\n" \
+    << "\t\tSpecify the number of threads used to parse and encode.\n" \
+    << "\t-r <runs>\n" \
+    << "\t\tSpecify the number of runs the median is taken over.\n" \
+    << "\t-t\n" \
+    << "\t\tAlso write the listing file in the working directory.\n" \
+    << std::endl;
+}
+
+// Returns the seconds since a time.
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - \
+                                         start).count();
+}
+
+// Returns the median of some times.
+double median(std::vector<double> times) {
+    std::sort(times.begin(), times.end());
+    return times.at(times.size() / 2);
+}
+
+// Returns the number of lines in the files of a program.
+size_t count_lines(const std::vector<std::string>& paths) {
+    size_t num_lines = 0;
+    for (const std::string& path : paths) {
+        std::ifstream file(path, std::ios::binary);
+        num_lines += std::count(std::istreambuf_iterator<char>(file), \
+                                std::istreambuf_iterator<char>(), '\n');
+    }
+    return num_lines;
+}
+
+// Displays a row of the results, with a throughput if there are lines.
+void print_row(const std::string& name, double time, size_t num_lines) {
+    std::cout << std::left << std::setw(NAME_WIDTH) << name << std::right \
+              << std::fixed << std::setprecision(3) << std::setw(TIME_WIDTH) \
+              << time * 1000 << " ms";
+    if ((num_lines > 0) && (time > 0)) {
+        std::cout << std::setprecision(0) << std::setw(RATE_WIDTH) \
+                  << num_lines / time << " lines/s";
+    }
+    std::cout << std::endl;
+}
+
+// Main function.
+int main(int argc, char* argv[]) {
+    std::string main_file_path;
+    std::string isa_file_path;
+    std::string output_file_path = DEFAULT_OUTPUT_PATH;
+    std::string cache_dir = DEFAULT_CACHE_DIR;
+    size_t jobs = 1;
+    size_t runs = DEFAULT_RUNS;
+    bool list = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = (i != argc - 1);
+        try {
+            if ((std::strcmp(argv[i], FILE_FLAG) == 0) && has_value) {
+                main_file_path = argv[++i];
+            }
+            else if ((std::strcmp(argv[i], ISA_FLAG) == 0) && has_value) {
+                isa_file_path = argv[++i];
+            }
+            else if ((std::strcmp(argv[i], OUT_FLAG) == 0) && has_value) {
+                output_file_path = argv[++i];
+            }
+            else if ((std::strcmp(argv[i], CACHE_FLAG) == 0) && has_value) {
+                cache_dir = argv[++i];
+            }
+            else if ((std::strcmp(argv[i], JOBS_FLAG) == 0) && has_value) {
+                jobs = std::stoul(argv[++i]);
+            }
+            else if ((std::strcmp(argv[i], RUNS_FLAG) == 0) && has_value) {
+                runs = std::stoul(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], LIST_FLAG) == 0) {
+                list = true;
+            }
+            else {
+                usageError(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        catch (const std::exception& e) {
+            usageError(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (main_file_path.empty() || isa_file_path.empty() || (runs == 0)) {
+        usageError(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    // Only errors are kept, the user library and assembler output nothing
+    // while being measured.
+    std::ostringstream errors;
+    NullStreamBuf null_buf;
+    std::streambuf* cout_buf = std::cout.rdbuf();
+    std::streambuf* cerr_buf = std::cerr.rdbuf();
+    std::streambuf* clog_buf = std::clog.rdbuf();
+    std::vector<std::vector<double>> times(NUM_STAGES);
+    std::vector<std::string> program_files;
+    double cold_load = 0;
+    bool done = true;
+
+    std::cout.rdbuf(&null_buf);
+    std::cerr.rdbuf(errors.rdbuf());
+    std::clog.rdbuf(&null_buf);
+    diagnostics::global().set_min_level(DIAG_ERROR);
+    // The first run rebuilds the user library, the others find it cached.
+    for (size_t run = 0; done && (run <= runs); run++) {
+        auto start = std::chrono::steady_clock::now();
+        lib_cache cache(cache_dir, run == 0);
+        isa cpu_isa(isa_file_path, cache);
+        double isa_load = seconds_since(start);
+        if (run == 0) {
+            cold_load = isa_load;
+            continue;
+        }
+        times.at(STAGE_ISA_LOAD).push_back(isa_load);
+
+        source_cache sources(cpu_isa);
+        start = std::chrono::steady_clock::now();
+        assembler gena(main_file_path, cpu_isa, sources, output_file_path, \
+                       image_writer::parse_format("hex"), false, list, \
+                       false, jobs, "");
+        done = gena.first_pass();
+        times.at(STAGE_FIRST_PASS).push_back(seconds_since(start));
+        start = std::chrono::steady_clock::now();
+        done = done && gena.encode_pass();
+        times.at(STAGE_SECOND_PASS).push_back(seconds_since(start));
+        start = std::chrono::steady_clock::now();
+        done = done && gena.write_output();
+        times.at(STAGE_OUTPUT).push_back(seconds_since(start));
+        if (list) {
+            start = std::chrono::steady_clock::now();
+            done = done && gena.write_listing();
+            times.at(STAGE_LISTING).push_back(seconds_since(start));
+        }
+        program_files = gena.program_files();
+    }
+    diagnostics::global().flush();
+    std::cout.rdbuf(cout_buf);
+    std::cerr.rdbuf(cerr_buf);
+    std::clog.rdbuf(clog_buf);
+    if (!done) {
+        std::cerr << errors.str() << main_file_path << " failed to assemble." \
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    size_t num_lines = count_lines(program_files);
+    double total = 0;
+    std::cout << main_file_path << ": " << num_lines << " lines in " \
+              << program_files.size() << " files, median of " << runs \
+              << " runs with " << jobs << " jobs." << std::endl;
+    print_row("ISA load (cold)", cold_load, 0);
+    for (size_t stage = 0; stage < NUM_STAGES; stage++) {
+        // The listing is only written with -t.
+        if (times.at(stage).empty()) {
+            std::cout << std::left << std::setw(NAME_WIDTH) \
+                      << STAGE_NAMES[stage] << std::right \
+                      << std::setw(TIME_WIDTH) << "n/a" << std::endl;
+            continue;
+        }
+        double time = median(times.at(stage));
+        // The ISA load is not per line.
+        print_row(STAGE_NAMES[stage], time, \
+                  (stage == STAGE_ISA_LOAD) ? 0 : num_lines);
+        total += time;
+    }
+    print_row("Total", total, num_lines);
+    std::cout << std::left << std::setw(NAME_WIDTH) << "Peak RSS" \
+              << std::right << std::setw(TIME_WIDTH) \
+              << usage.ru_maxrss / KB_PER_MB << " MB" << std::endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+// arena.hpp
+// Include file for the arena class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <type_traits>
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+// Constants.
+// The size of each block allocated by an arena, larger allocations get a
+// block of their own.
+const size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+// Allocates memory by bumping a pointer through large blocks. Nothing is freed
+// on its own, every block is freed at once when the arena is cleared or
+// destroyed. Only trivially copyable and destructible values are kept. Not
+// thread safe, threads each use their own arena.
+class arena {
+	// Publicly usable.
+	public:
+		// Constructor.
+		arena();
+
+		// Destructor.
+		~arena();
+
+        // Memory is owned by exactly one arena.
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+        arena(arena&&) = default;
+        arena& operator=(arena&&) = default;
+
+		// Public Methods
+        // This function takes in a size and an alignment in bytes and returns
+        // memory for them that lives as long as the arena.
+        void* allocate(size_t size, size_t align);
+        // This function takes in values and their count and returns a copy of
+        // them in the arena, NULL if there are none.
+        template <typename T>
+        T* copy(const T* values, size_t count) {
+            static_assert(std::is_trivially_copyable<T>::value && \
+                          std::is_trivially_destructible<T>::value, \
+                          "Arena values are never destroyed.");
+            if (count == 0) {
+                return NULL;
+            }
+            T* out = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+            std::memcpy(out, values, sizeof(T) * count);
+            return out;
+        }
+        // This function takes in text and returns a copy of it in the arena.
+        std::string_view copy(std::string_view text);
+        // This function frees every block.
+        void clear(void);
+
+        // Accessors
+        // The bytes allocated from the arena and the bytes of its blocks.
+        size_t bytes_used(void) const;
+        size_t bytes_reserved(void) const;
+
+	// Private usage only.
+	private:
+		// Private data members.
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        // The free part of the current block.
+        char* pos_;
+        char* end_;
+        size_t used_;
+        size_t reserved_;
+
+        // Helper functions
+        // This function takes in a size and adds a block of it, returning the
+        // block.
+        char* new_block(size_t size);
+        // This function takes in a pointer and an alignment and returns the
+        // first pointer at or after it with the alignment.
+        static char* align_up(char* pos, size_t align);
+};
+
+#endif // ARENA_HPP
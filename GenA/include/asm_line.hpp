@@ -6,8 +6,13 @@
 // Included libraries.
 #include <stdlib.h>
 #include <string>
+#include <string_view>
 #include <unordered_map>
-#include <assembler.hpp>
+#include <vector>
+#include "code_macro.hpp"
+#include "symbol_pool.hpp"
+#include "symbol_table.hpp"
+#include "gena_abi.h"
 
 
 #ifndef ASM_LINE_HPP
@@ -22,9 +27,19 @@ class asm_line {
 	// Publicly usable.
 	public:
 		// Constructor.
-        // Takes in and updates all data members.
-		asm_line(std::string origin_file_path, std::string text, \
-                 std::string label, std::string op_name, std::string operand);
+        // Takes in and updates all data members. The text points into the
+        // source and the label, operation name and operand point into the
+        // lexed line, both must outlive the asm_line, as must the origin file
+        // path.
+        // The code macro is the one the line was matched to and the arguments
+        // are the values matched from its operand, lines without an operation
+        // have no code macro. The arguments are kept where they are, in the
+        // arena of the file, and not copied.
+		asm_line(std::string_view origin_file_path, std::string_view text, \
+                 std::string_view label, std::string_view op_name, \
+                 std::string_view operand, \
+                 const code_macro* macro = NULL, op_arg* arguments = NULL, \
+                 size_t num_arguments = 0);
 		
 		// Destructor.
 		~asm_line();
@@ -38,35 +53,74 @@ class asm_line {
 		// size_t assemble(isa cpu_isa, 
 		// 	            std::unordered_map<std::string, size_t> symbol_table);
 
-        // This function takes in the isa of a cpu and returns the size in bits
-        // of this line of assembly.
-        size_t size(isa cpu_isa);
-        // This function takes in the isa of a cpu and returns the program data
-        // as a size_t.
-        size_t assemble(isa cpu_isa, \
-                        std::unordered_multimap<std::string, size_t> table, \
-                        size_t pc);
+        // This function returns the size in bits of this line of assembly.
+        size_t size(void) const;
+        // This function takes in a symbol pool and interns the label and
+        // every argument that is not the program counter, so symbols are
+        // looked up by id.
+        void intern(symbol_pool& pool);
+        // This function takes in the symbol table, the program counter and
+        // encoder operands to update, and fills in the operands of this line
+        // for its code macro. Arguments that are defined symbols take their
+        // values. Returns false if the line has no code macro.
+        bool operands(const symbol_table& table, size_t pc, \
+                      gena_operands& ops) const;
+        // This function takes in a code macro, the start of the operand its
+        // arguments are slices of, the arguments and their number, the symbol
+        // table, the program counter and encoder operands to update, and
+        // fills in the operands as above. Lets the operands of a line be
+        // built from the columns of a program image without the line.
+        static bool operands(const code_macro* macro, const char* operand, \
+                             const op_arg* args, size_t num_args, \
+                             const symbol_table& table, size_t pc, \
+                             gena_operands& ops);
+        // This function takes in the symbol table, the program counter and
+        // the program data to set, and encodes the line. Returns false if the
+        // line can not be encoded.
+        bool assemble(const symbol_table& table, size_t pc, \
+                      uint64_t& out) const;
 		
 		// Accessors
 		// All directly from data members.
-		std::string origin_file(void);
-		std::string text(void);
-		std::string label(void);
+		std::string_view origin_file(void) const;
+		std::string_view text(void) const;
+		std::string_view label(void) const;
+		// The id of the label, SYMBOL_NONE if there is none or the line has
+		// not been interned.
+		uint32_t label_symbol(void) const;
+		std::string_view op_name(void) const;
+		std::string_view operand(void) const;
+		const code_macro* macro(void) const;
+		const op_arg* arguments(void) const;
+		size_t num_arguments(void) const;
 
 
 	// Private usage only.
 	private:
 		// Private data members.
-		// The path of the file the assembly line is from.
-		std::string origin_file_path_;
+		// The path of the file the assembly line is from, shared by every
+		// line of the file.
+		std::string_view origin_file_path_;
 		// The assembly line as text.
-		std::string text_;
-		// The label in the assembly line.
-		std::string label_;  
+		std::string_view text_;
+		// The label in the assembly line and its id.
+		std::string_view label_;  
+		uint32_t label_symbol_;
 		// The operation name in the assembly line.
-		std::string op_name_;  
+		std::string_view op_name_;  
 		// The operand in the assembly line.
-		std::string operand_;  
+		std::string_view operand_;  
+		// The code macro the line was matched to, NULL if it has none.
+		const code_macro* macro_;
+		// The arguments matched from the operand by the code macro, as slices
+		// of the operand.
+		op_arg* arguments_;
+		size_t num_arguments_;
+
+        // Helper functions
+        // This function takes in the text of an argument that is not a symbol
+        // and updates the operand with its kind and value.
+        static void parse_operand(std::string_view text, gena_operand& op);
 };
 
 #endif // ASM_LINE_HPP
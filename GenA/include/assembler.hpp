@@ -9,24 +9,57 @@
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
-#include <list>
+#include <memory>
+#include <atomic>
+#include <chrono>
 #include <sys/ioctl.h>
 #include <iostream>
 #include <isa.hpp>
+#include "segment_image.hpp"
+#include "lib_cache.hpp"
+#include "source_cache.hpp"
+#include "chunk_runner.hpp"
+#include "image_writer.hpp"
+#include "build_db.hpp"
+#include "assembly_stats.hpp"
+#include "symbol_table.hpp"
 
 #ifndef ASSEMBLER_HPP
 #define ASSEMBLER_HPP
 
-class asm_line;
+// A file being read for the first pass, as its path, its parsed lines, the
+// index of its next logical line and its index in the program files.
+struct source_frame {
+    std::string path;
+    const std::vector<parsed_line>* lines;
+    size_t line;
+    size_t file;
+};
 
 class assembler {
 	// Publicly usable.
 	public:
 		// Constructor.
 		// Takes the path to the entry path and the path to the isa file as 
-        // strings and initializes all data.
+        // strings and initializes all data. The output file is written in the
+        // output format. The cache directory and rebuild flag control where
+        // the ISA user library is cached. The number of jobs is the number of
+        // threads used to parse and encode the program. If the build database
+        // path is not empty, files and instructions recorded in it are reused
+        // and it is updated after the second pass. With relax, instructions
+        // the ISA can relax take their shortest form that reaches their
+        // target.
 		assembler(std::string entry_path, std::string isa_path, \
-                  std::string output_folder_path, bool verbose, bool list);
+                  std::string output_folder_path, output_format format, \
+                  bool verbose, bool list, bool relax, std::string cache_dir, \
+                  bool rebuild, size_t jobs, std::string build_db_path);
+        // Takes the path to the entry path, an ISA and a source cache for it
+        // that are kept by the caller, and initializes all other data as
+        // above.
+		assembler(std::string entry_path, isa& cpu_isa, \
+                  source_cache& sources, std::string output_folder_path, \
+                  output_format format, bool verbose, bool list, bool relax, \
+                  size_t jobs, std::string build_db_path);
 		
 		// Destructor.
 		~assembler();
@@ -35,9 +68,27 @@ class assembler {
         // Performs the first pass on the assembly files. Returns true if
         // successful.
         bool first_pass(void);
-        // Performs the second pass the assembly files. Returns true if success.
+        // Performs the second pass the assembly files and writes the output
+        // file. Returns true if success.
         bool second_pass(void);
+        // The three stages of the second pass, run by it in order. The first
+        // encodes the program and displays an error for every instruction
+        // that can not be encoded, the second writes the output file and the
+        // build database, and the third writes the listing file from the
+        // encoded program if there is one. Each returns true if successful.
+        bool encode_pass(void);
+        bool write_output(void);
+        bool write_listing(void);
 
+        // Accessors
+        // The parsed files of the program.
+        const source_cache& sources(void) const;
+        // The paths of the files of the program as they were given, in the
+        // order they were included.
+        const std::vector<std::string>& program_files(void) const;
+        // The times and counters of the phases run so far. The ISA path and
+        // success are left for the caller.
+        assembly_stats stats(void) const;
 
 	// Private usage only.
 	private:
@@ -46,34 +97,124 @@ class assembler {
         std::string entry_path_;
         // Valid assembly file extensions based on entry file.
         std::string valid_extension_;
+        // The build cache, ISA and source cache when the assembler owns them.
+        std::unique_ptr<lib_cache> own_lib_cache_;
+        std::unique_ptr<isa> own_isa_;
+        std::unique_ptr<source_cache> own_sources_;
         // The ISA object for the cpu being assembled.
-        isa cpu_isa_; 
+        isa& cpu_isa_; 
+        // The parsed lines of every file read.
+        source_cache& sources_;
         // The path to the output file.
         std::string output_file_path_;
+        // The format of the output file.
+        output_format format_;
         // Whether to output to terminal or not.
         bool verbose_;        
         // Whether to have a listing output or not.
         bool list_;
+        // Whether to relax instructions to their shortest form.
+        bool relax_;
+        // Runs the chunks of parsing and encoding on the number of jobs.
+        chunk_runner runner_;
         // The program counter static for user library to use.
         size_t pc_;
         // The amount of words of data memory being used.
         size_t data_used_;
-        // The symbol table.
-		std::unordered_multimap<std::string, size_t> symbol_table_;
+        // The symbol table, indexed by the ids of the symbol pool of the
+        // source cache.
+        symbol_table symbol_table_;
+        // The id of every label and the index of the program image line it
+        // is defined at, so labels follow their lines when they move.
+        std::vector<std::pair<uint32_t, size_t>> label_lines_;
         // All file paths used for the assembled program.
         std::unordered_set<std::string> asm_file_paths_;
-        // The collection of assembly lines that are the program itself.
-        std::list<asm_line> asm_prog_;
+        // The paths of the files of the program in the order they were read.
+        std::vector<std::string> program_files_;
+        // The build database, NULL if there is none.
+        std::unique_ptr<build_db> db_;
+        // The program image, the assembly lines of the program keyed by the
+        // address they are placed at, in address order after the first pass.
+        segment_image prog_image_;
+        // The encoded instruction, whether it was encoded and the build
+        // database key of each line of the program image, from the encoding
+        // stage of the second pass. Success is kept apart from the value
+        // since any 64 bit value can be an instruction.
+        std::vector<uint64_t> encoded_;
+        std::vector<uint8_t> encoded_ok_;
+        std::vector<std::string> keys_;
+        // The stats of this assembly, holding the templates tried by the ISA
+        // before it started in place of the templates tried during it.
+        assembly_stats stats_;
         
         // Helper functions
-        // This function takes in a line with a pseudo operation as a string, a 
-        // file bool to modify and a file name file pair list to modify and 
-        // a line number and updates the data members and some args depending on 
-        // the lines pseudo operation. Returns true if successful, and false if
-        // not, an error message is also displayed.
-        bool pseudo_op_handler(std::string line, bool& next_file, \
-        std::vector<std::pair<std::pair<std::string, size_t>, std::ifstream>>& \
-        asm_file_stack);
+        // This function gives every line of the program image the ISA can
+        // relax the smallest form that reaches its target, moving the lines
+        // and labels after it, and returns the number of lines relaxed.
+        // Lines start at their smallest form and only grow, to the next form
+        // up, while their target is out of range, so it ends once no line
+        // grows. Runs keep their start address. The target of a line is its
+        // first argument that is a label, lines without one are not relaxed.
+        size_t relax(void);
+        // This function fills in the stats known before the first pass.
+        void start_stats(void);
+        // This function takes in a time and returns the seconds since it.
+        static double seconds_since(std::chrono::steady_clock::time_point \
+                                    start);
+        // This function takes in the encoded instructions and whether each was
+        // encoded, and sets them for each line of the program image. Lines
+        // without an instruction or that can not be encoded are marked as not
+        // encoded. Instructions of functions with a batch
+        // encoder are grouped by function and encoded in batches. The lines are
+        // split into chunks that are encoded by the runner, each result is
+        // stored by position so the output does not depend on which thread
+        // encoded it. With a build database, the operands of each line are
+        // updated as its key in keys and instructions whose operands are
+        // recorded are not encoded again. The symbol lookups made are added to
+        // the count of lookups.
+        void encode_program(std::vector<uint64_t>& encoded, \
+                            std::vector<uint8_t>& encoded_ok, \
+                            std::vector<std::string>& keys, \
+                            uint64_t& num_lookups) const;
+        // This function takes in a range of the lines of the program image,
+        // the encoded instructions, whether each was encoded and keys to
+        // update and counts of reused
+        // instructions and symbol lookups to update, and encodes the lines in
+        // the range from the columns of the image.
+        void encode_range(size_t begin, size_t end, \
+                          std::vector<uint64_t>& encoded, \
+                          std::vector<uint8_t>& encoded_ok, \
+                          std::vector<std::string>& keys, \
+                          std::atomic<size_t>& num_reused, \
+                          std::atomic<uint64_t>& num_lookups) const;
+        // This function takes in a code macro and its operands and returns
+        // the key they are recorded under in the build database.
+        std::string operands_key(const code_macro* macro, \
+                                 const gena_operands& ops) const;
+        // This function takes in the keys and encoded instructions of the
+        // lines in address order and whether each was encoded and updates the build database with the
+        // program, writing it if it changed. Returns false if it can not be
+        // written.
+        bool update_build_db(const std::vector<std::string>& keys, \
+                             const std::vector<uint64_t>& encoded, \
+                             const std::vector<uint8_t>& encoded_ok);
+        // This function takes in the path to a build database and opens it,
+        // unless the path is empty.
+        void open_build_db(const std::string& path);
+        // This function takes in a line with a pseudo operation as a string,
+        // its line number, a file bool to modify and a file stack to modify
+        // and updates the data members and some args depending on the lines
+        // pseudo operation. Returns true if successful, and false if not, an
+        // error message is also displayed.
+        bool pseudo_op_handler(const std::string& line, size_t line_num, \
+                               bool& next_file, \
+                               std::vector<source_frame>& asm_file_stack);
+        // This function takes in the id of a symbol, its value and kind and
+        // the frame and line defining it, and defines it. If it is already
+        // defined an error is displayed with where it was first defined and
+        // false is returned.
+        bool define_symbol(uint32_t id, size_t value, symbol_kind kind, \
+                           const source_frame& frame, size_t line_num);
 };
 
 #endif // ASSEMBLER_HPP
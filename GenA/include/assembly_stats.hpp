@@ -0,0 +1,64 @@
+// assembly_stats.hpp
+// Include file for the assembly_stats struct.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include <map>
+
+#ifndef ASSEMBLY_STATS_HPP
+#define ASSEMBLY_STATS_HPP
+
+// Constants.
+// The version of the stats report, changed when fields are renamed or
+// removed.
+const uint64_t ASSEMBLY_STATS_VERSION = 1;
+
+// The time taken by each phase of one assembly and counts of the work done in
+// it. Times are in seconds. Phases that were not run, such as loading an ISA
+// kept loaded by a server, take no time.
+struct assembly_stats {
+    std::string entry_path;
+    std::string isa_path;
+    size_t jobs;
+    bool success;
+    // Parsing the ISA file, compiling its user library or finding it cached,
+    // and opening the library and resolving its functions.
+    double isa_parse;
+    double lib_compile;
+    double lib_load;
+    double first_pass;
+    // Encoding the program, writing the output file and build database, and
+    // writing the listing file.
+    double second_pass;
+    double output;
+    double listing;
+    uint64_t files;
+    // Logical lines read in the first pass, those matched to a code macro,
+    // and the operand templates tried to match them. Lines restored from a
+    // build database are not matched again.
+    uint64_t lines;
+    uint64_t macros_matched;
+    uint64_t match_attempts;
+    // Symbol table lookups for labels defined and operands encoded.
+    uint64_t symbol_lookups;
+    uint64_t instructions;
+    // Instructions relaxed to a shorter form.
+    uint64_t relaxed;
+    // The size of the output file.
+    uint64_t bytes_emitted;
+    // The peak resident memory of the process in kilobytes.
+    uint64_t peak_rss_kb;
+    // The number of diagnostics reported with each code.
+    std::map<std::string, uint64_t> diag_counts;
+
+    // This function takes in a stream and writes the stats to it as a JSON
+    // object.
+    void write_json(std::ostream& out) const;
+};
+
+#endif // ASSEMBLY_STATS_HPP
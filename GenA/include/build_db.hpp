@@ -0,0 +1,129 @@
+// build_db.hpp
+// Include file for the build_db class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifndef BUILD_DB_HPP
+#define BUILD_DB_HPP
+
+// Constants.
+// The code macro index of lines without an operation and of invalid lines.
+const uint64_t BUILD_DB_NO_MACRO = UINT64_MAX;
+const uint64_t BUILD_DB_INVALID = UINT64_MAX - 1;
+
+// A build database kept between runs of the assembler for one ISA. It holds
+// each assembly file as it was parsed, keyed by absolute path and content
+// hash, so unchanged files are restored without being lexed or matched, and
+// the encoded instruction of every set of operands encoded, so instructions
+// whose operands did not change are not encoded again. A database written for
+// a different ISA or user library is ignored.
+class build_db {
+	// Publicly usable.
+	public:
+        // A slice of a buffer of a file record.
+        struct slice {
+            uint64_t pos;
+            uint64_t len;
+        };
+        // A matched argument of a line, as in op_arg.
+        struct arg_record {
+            uint64_t pos;
+            uint64_t len;
+            uint8_t pc;
+        };
+        // A logical line of a file. Work slices are of the lexed file and
+        // text slices are of the original text of the lines.
+        struct line_record {
+            uint64_t line_num;
+            uint8_t pseudo;
+            slice work;
+            slice text;
+            slice label;
+            slice op_name;
+            slice operand;
+            // The index of the code macro of the line in its ISA, or
+            // BUILD_DB_NO_MACRO or BUILD_DB_INVALID.
+            uint64_t macro;
+            std::vector<arg_record> args;
+            std::string diagnostic;
+        };
+        // A parsed file.
+        struct file_record {
+            uint64_t hash;
+            // The file after lexing and the original text of its lines.
+            std::string work;
+            std::string text;
+            std::vector<line_record> lines;
+        };
+
+		// Constructor.
+		// Takes in the path of the database file and the fingerprint of the
+        // ISA it is for. The database starts empty.
+		build_db(std::string path, uint64_t isa_fingerprint);
+
+		// Destructor.
+		~build_db();
+
+		// Public Methods
+        // This function reads the database file. Returns false and leaves the
+        // database empty if the file does not exist, is damaged or is for a
+        // different ISA.
+        bool load(void);
+        // This function writes the database file. Returns false if it can not
+        // be written.
+        bool save(void) const;
+        // This function takes in an absolute path and a content hash and
+        // returns the record of the file if it was recorded with those
+        // contents, otherwise NULL.
+        const file_record* file(const std::string& path, uint64_t hash) const;
+        // This function takes in an absolute path and a record and records
+        // the file.
+        void set_file(const std::string& path, file_record record);
+        // This function takes in the absolute paths of files and forgets
+        // every other file. Returns true if any file was forgotten.
+        bool keep_files(const std::unordered_set<std::string>& paths);
+        // This function takes in the operands of an instruction as a key and
+        // an encoded instruction to update. Returns false if the operands were
+        // not encoded before.
+        bool result(const std::string& key, uint64_t& encoded) const;
+        // This function takes in every key and encoded instruction of a build
+        // and replaces the recorded results with them.
+        void set_results(std::unordered_map<std::string, uint64_t> results);
+
+        // Accessors
+        const std::string& path(void) const;
+        size_t num_results(void) const;
+
+	// Private usage only.
+	private:
+		// Private data members.
+        std::string path_;
+        uint64_t isa_fingerprint_;
+        std::unordered_map<std::string, file_record> files_;
+        std::unordered_map<std::string, uint64_t> results_;
+
+        // Helper functions
+        // These functions take in a buffer and append a value to it.
+        static void put_u64(std::string& out, uint64_t value);
+        static void put_string(std::string& out, const std::string& str);
+        // These functions take in a buffer and a position in it and read a
+        // value at the position, moving it past the value. Return false if
+        // the buffer ends first.
+        static bool get_u64(const std::string& in, size_t& pos, \
+                            uint64_t& value);
+        static bool get_string(const std::string& in, size_t& pos, \
+                               std::string& str);
+        // This function takes in the contents of a database file and reads
+        // it. Returns false if it is damaged or for another ISA.
+        bool parse(const std::string& in);
+};
+
+#endif // BUILD_DB_HPP
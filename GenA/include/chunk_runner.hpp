@@ -0,0 +1,43 @@
+// chunk_runner.hpp
+// Include file for the chunk_runner class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <functional>
+
+#ifndef CHUNK_RUNNER_HPP
+#define CHUNK_RUNNER_HPP
+
+// Runs independent chunks of work on a fixed number of threads. The calling
+// thread works too, so a runner with one job runs every chunk in order on the
+// calling thread.
+class chunk_runner {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Takes in the most threads to run chunks on, at least one is used.
+		chunk_runner(size_t jobs);
+
+		// Destructor.
+		~chunk_runner();
+
+		// Public Methods
+        // This function takes in a number of chunks and a function that does
+        // a chunk given its index, and runs every chunk. Chunks must not
+        // depend on each other and may run in any order.
+        void run(size_t num_chunks, \
+                 const std::function<void(size_t)>& work) const;
+
+        // Accessors
+        size_t jobs(void) const;
+
+	// Private usage only.
+	private:
+		// Private data members.
+        // The most threads chunks are run on.
+        size_t jobs_;
+};
+
+#endif // CHUNK_RUNNER_HPP
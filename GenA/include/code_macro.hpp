@@ -7,6 +7,8 @@
 #include <stdlib.h>
 #include <string>
 #include <vector>
+#include "op_matcher.hpp"
+#include "gena_abi.h"
 
 #ifndef CODE_MACRO_HPP
 #define CODE_MACRO_HPP
@@ -14,24 +16,36 @@
 class code_macro {
 	// Publicly usable.
 	public:
+        // The string ABI user function.
         using func_ptr = size_t(*)(size_t, std::vector<std::string>);
 		// Constructor.
-		// Takes in, and updates all data.
+		// Takes in, and updates all data. The operand template is compiled
+        // into the operand matcher. Exactly one of the string ABI function
+        // and the binary ABI encoder is used, the other is NULL. The batch
+        // encoder is optional and only used with the binary ABI encoder.
 		code_macro(size_t op_code, std::vector<std::string> operand_template, \
-                   func_ptr func, size_t num_inst_bits);
+                   func_ptr func, gena_encode_fn encoder, \
+                   gena_encode_batch_fn batch_encoder, size_t num_inst_bits);
 		
 		// Destructor.
 		~code_macro();
 
 		// Public Methods
+        // This function takes in the operands of an instruction with the op
+        // code filled in and updates out with the encoded instruction. String
+        // ABI functions are called through an adapter that passes the operands
+        // as text. Returns false if the operands can not be encoded.
+        bool encode(const gena_operands& ops, uint64_t& out) const;
+
         // Accessors 
-		size_t op_code(void);
-		std::vector<std::string> operand_template(void);
-		func_ptr func(void);
-        size_t num_inst_bits(void);
+		size_t op_code(void) const;
+		const std::vector<std::string>& operand_template(void) const;
+		func_ptr func(void) const;
+		gena_encode_fn encoder(void) const;
+		gena_encode_batch_fn batch_encoder(void) const;
+        size_t num_inst_bits(void) const;
+        const op_matcher& matcher(void) const;
 
-        // Public list of arguments when matched by the isa to an asm line.
-        std::vector<std::string> arguments;
 	// Private usage only.
 	private:
 		// Private data members.
@@ -41,8 +55,14 @@ class code_macro {
 		std::vector<std::string> operand_template_;
 		// Function pointer for translating operands to instructions.
 		func_ptr func_;
+		// The binary ABI encoder, used instead of func_ if it is not NULL.
+		gena_encode_fn encoder_;
+		// The batch encoder for the encoder, NULL if there is none.
+		gena_encode_batch_fn batch_encoder_;
         // Number of bits in the instruction.
         size_t num_inst_bits_;
+        // The compiled operand template.
+        op_matcher matcher_;
 };
 
 #endif // CODE_MACRO_HPP
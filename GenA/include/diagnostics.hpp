@@ -0,0 +1,107 @@
+// diagnostics.hpp
+// Include file for the diagnostics class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <ostream>
+#include <mutex>
+#include <map>
+
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+// The severity of a diagnostic, in increasing order.
+enum diag_level {
+    DIAG_INFO,
+    DIAG_WARNING,
+    DIAG_ERROR,
+    NUM_DIAG_LEVELS
+};
+
+// Where a diagnostic is from. The code is a short name for the kind of
+// diagnostic that does not change between versions. A line or column of 0
+// is not known, as is an empty file.
+struct diag_record {
+    diag_level level;
+    const char* code;
+    std::string_view file;
+    size_t line;
+    size_t column;
+};
+
+// Collects the diagnostics of the process. Errors are written to std::cerr
+// and everything else to std::clog, in the order they were reported, through
+// a buffer that is written when it fills, when the stream changes and when
+// flushed. Diagnostics below the lowest level written are counted but never
+// formatted. Anything buffered is written when the process exits or forks.
+class diagnostics {
+	// Publicly usable.
+	public:
+        // This function returns the diagnostics of the process.
+        static diagnostics& global(void);
+
+        // The diagnostics are shared by the whole process.
+        diagnostics(const diagnostics&) = delete;
+        diagnostics& operator=(const diagnostics&) = delete;
+
+		// Public Methods
+        // This function takes in a record and a function that writes the
+        // message to a stream, and reports the diagnostic. The message is
+        // only formatted if its level is written. Messages are written after
+        // "Error: " or "Warning: " and before the line and file they are from.
+        template <typename Format>
+        void report(const diag_record& record, Format format) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            counts_[record.code]++;
+            if (record.level < min_level_) {
+                return;
+            }
+            begin(record);
+            format(static_cast<std::ostream&>(buffer_));
+            end(record);
+        }
+        // This function takes in a level and returns whether diagnostics of
+        // it are written.
+        bool enabled(diag_level level) const;
+        // This function takes in the lowest level to write. NUM_DIAG_LEVELS
+        // writes nothing.
+        void set_min_level(diag_level level);
+        // This function writes everything buffered to its stream.
+        void flush(void);
+        // This function returns the number of diagnostics reported with each
+        // code.
+        std::map<std::string, uint64_t> counts(void) const;
+        // This function sets the number of diagnostics reported with every
+        // code back to zero.
+        void reset_counts(void);
+
+	// Private usage only.
+	private:
+		// Constructor.
+		diagnostics();
+
+		// Private data members.
+        mutable std::mutex mutex_;
+        diag_level min_level_;
+        // The stream the buffer is for, NULL if it is empty.
+        std::ostream* target_;
+        std::ostringstream buffer_;
+        std::map<std::string, uint64_t> counts_;
+
+        // Helper functions
+        // These functions take in a record and write what comes before and
+        // after its message to the buffer, switching the buffer to the stream
+        // of the record first.
+        void begin(const diag_record& record);
+        void end(const diag_record& record);
+        // This function writes the buffer to its stream without locking.
+        void flush_buffer(void);
+};
+
+#endif // DIAGNOSTICS_HPP
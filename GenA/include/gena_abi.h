@@ -0,0 +1,83 @@
+/* gena_abi.h
+ * The binary ABI between GenA and ISA user libraries.
+ * Revision History:
+ * 10/17/26 agent Initial Revision.
+ *
+ * A user library opts in to the binary ABI by exporting gena_abi_version,
+ * returning GENA_ENCODER_ABI_VERSION. Every function named in its ISA file is
+ * then an encoder of type gena_encode_fn, and may also export a batch encoder
+ * of type gena_encode_batch_fn named after it with GENA_BATCH_SUFFIX. Batch
+ * encoders are given every instruction that uses the function at once.
+ * Libraries that do not export gena_abi_version use the original string ABI,
+ *     size_t func(size_t opcode, std::vector<std::string> args)
+ * where the arguments are the operand values as text from last to first.
+ */
+
+#ifndef GENA_ABI_H
+#define GENA_ABI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GENA_ENCODER_ABI_VERSION 1
+/* The most operands passed to an encoder. */
+#define GENA_MAX_OPERANDS 8
+
+/* The suffix of the name of a batch encoder. */
+#define GENA_BATCH_SUFFIX "_batch"
+
+/* Encoder return codes. */
+#define GENA_ENCODE_OK 0
+#define GENA_ENCODE_ERROR 1
+
+/* Kinds of operands. */
+enum gena_operand_kind {
+    /* A decimal number written in the operand, value is the number. */
+    GENA_OPERAND_INTEGER = 0,
+    /* A label, variable or constant, value is what it was defined as. */
+    GENA_OPERAND_SYMBOL = 1,
+    /* Letters followed by a decimal number like r16, value is the number. */
+    GENA_OPERAND_REGISTER = 2,
+    /* Any other text, value is 0. */
+    GENA_OPERAND_NAME = 3,
+    /* A program counter slot, value is the address of the instruction in
+     * bits. */
+    GENA_OPERAND_PC = 4
+};
+
+/* An operand of an instruction. The text is the lowercase operand as written
+ * in the source and is only valid during the call. */
+typedef struct gena_operand {
+    uint32_t kind;
+    int64_t value;
+    const char* text;
+    size_t text_len;
+} gena_operand;
+
+/* The operands of an instruction in the order they are written. */
+typedef struct gena_operands {
+    uint32_t abi_version;
+    uint32_t count;
+    uint64_t op_code;
+    gena_operand operands[GENA_MAX_OPERANDS];
+} gena_operands;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Encodes an instruction, writing its bits to out. Returns GENA_ENCODE_OK, or
+ * GENA_ENCODE_ERROR if the operands can not be encoded. */
+typedef int (*gena_encode_fn)(const gena_operands* ops, uint64_t* out);
+/* Encodes count instructions, writing the bits of ops[i] to out[i]. Returns
+ * GENA_ENCODE_OK, or GENA_ENCODE_ERROR if any of them can not be encoded. */
+typedef int (*gena_encode_batch_fn)(const gena_operands* ops, size_t count, \
+                                    uint64_t* out);
+/* Returns the binary ABI version the library was built for. */
+typedef uint32_t (*gena_abi_version_fn)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GENA_ABI_H */
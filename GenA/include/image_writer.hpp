@@ -0,0 +1,102 @@
+// image_writer.hpp
+// Include file for the image_writer class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#ifndef IMAGE_WRITER_HPP
+#define IMAGE_WRITER_HPP
+
+// Constants.
+// The output file formats.
+enum output_format {
+    FORMAT_INTEL_HEX,
+    FORMAT_SREC,
+    FORMAT_BINARY,
+    FORMAT_INVALID
+};
+// The names of the output formats in the order of output_format.
+const std::vector<std::string> FORMAT_NAMES = {"hex", "srec", "bin"};
+
+// Writes the assembled contents of a memory segment as an Intel HEX,
+// Motorola S-record or raw binary file. Words are added in address order and
+// kept as runs of contiguous bytes, each word being the fewest whole bytes
+// that hold it. Values are split into units that are written most significant
+// unit first, and the bytes of a unit are written most significant first, or
+// least significant first when little endian. Records are batched into a
+// single buffer that is written to the file at once.
+class image_writer {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Takes in the output format, the size of a word of the segment in
+        // bits, whether units are little endian and the size of a unit in
+        // bits, 0 for the whole value.
+		image_writer(output_format format, size_t word_bits, \
+                     bool little_endian, size_t unit_bits);
+
+		// Destructor.
+		~image_writer();
+
+		// Public Methods
+        // This function takes in a word address, a value and its size in bits
+        // and adds the value to the segment. Values must be added in address
+        // order and must not overlap.
+        void add(size_t word_address, size_t value, size_t num_bits);
+        // This function takes in an output stream and writes the segment to it
+        // in the output format with a single write. Returns false if the
+        // stream fails.
+        bool write(std::ostream& file) const;
+        // This function takes in a format name and returns its format, or
+        // FORMAT_INVALID if there is no such format.
+        static output_format parse_format(const std::string& name);
+
+        // Accessors
+        size_t num_bytes(void) const;
+
+	// Private usage only.
+	private:
+        // Contiguous bytes starting at a byte address.
+        struct byte_run {
+            size_t address;
+            std::vector<uint8_t> bytes;
+        };
+
+		// Private data members.
+        output_format format_;
+        // The number of bytes in a word.
+        size_t word_bytes_;
+        bool little_endian_;
+        // The number of bytes in a unit, 0 for the whole value.
+        size_t unit_bytes_;
+        // The runs of bytes in address order.
+        std::vector<byte_run> runs_;
+
+        // Helper functions
+        // These functions take in a buffer and append the segment to it in
+        // their format.
+        void format_intel_hex(std::string& out) const;
+        void format_srec(std::string& out) const;
+        void format_binary(std::string& out) const;
+        // This function takes in a buffer, a record type, a 16 bit address
+        // and record data, and appends an Intel HEX record.
+        static void hex_record(std::string& out, uint8_t type, \
+                               uint16_t address, const uint8_t* data, \
+                               size_t len);
+        // This function takes in a buffer, a record type, the number of
+        // address bytes, an address and record data, and appends an S-record.
+        static void srec_record(std::string& out, char type, \
+                                size_t address_bytes, size_t address, \
+                                const uint8_t* data, size_t len);
+        // This function takes in a buffer and a byte and appends the byte as
+        // two uppercase hex digits.
+        static void append_byte(std::string& out, uint8_t byte);
+};
+
+#endif // IMAGE_WRITER_HPP
@@ -5,61 +5,122 @@
 
 // Included libraries.
 #include <stdlib.h>
+#include <stdint.h>
 #include <string>
 #include <unordered_map>
 #include "code_macro.hpp"
+#include "lib_cache.hpp"
+#include "user_lib.hpp"
+#include "mnemonic_table.hpp"
+#include "line_lexer.hpp"
+#include "arena.hpp"
+#include <memory>
+#include <atomic>
 #include <vector>
+#include <string_view>
+#include <ostream>
 
 #ifndef ISA_HPP
 #define ISA_HPP
 
 // Constants.
 const size_t ISA_INVALID = std::string::npos;
-const std::string PC = "$Val";
 
 
 class asm_line;
 
+// The seconds an ISA took to load, split into parsing the ISA file, compiling
+// its user library or finding it cached, and opening the library and
+// resolving its functions.
+struct isa_load_times {
+    double parse;
+    double compile;
+    double load;
+};
+
+// A shorter form a code macro may be relaxed to, taken when the target of the
+// line is from min to max words of program memory away from the line.
+struct relax_form {
+    const code_macro* macro;
+    int64_t min;
+    int64_t max;
+};
+
 class isa {
 	// Publicly usable.
 	public:
 		// Constructor.
 		// Takes in the isa_file_path as a string to parse the isa file 
-		// updating all data. If the file path does not exist an invalid ISA
-        // will be returned and an error message will be displayed.
-		isa(std::string isa_file_path);
+		// updating all data and the cache used to build the user library. If
+        // the file path does not exist an invalid ISA will be returned and an
+        // error message will be displayed.
+		isa(std::string isa_file_path, lib_cache& user_lib_cache);
 
+        // The isa owns its user library and is always passed by reference.
+        isa(const isa&) = delete;
+        isa& operator=(const isa&) = delete;
 		
 		// Destructor.
 		~isa();
 
 		// Public Methods
-		// This function takes in a line of assembly and file path as strings
-        // and returns an asm_line object parsed from that string. This function
-        // will display an error message if the line of assembly does not match
-        // any code macro and the returned asm line will have ASM_INVALID for 
-        // each of its data members.
-		asm_line parse_asm(std::string line, std::string file_path);
+		// This function takes in a line of assembly as a writable buffer and
+        // its length, the original text of the line, the file path and an
+        // arena, and returns an asm_line object parsed from that line. The
+        // line is lexed in place and the asm_line points into it, the original
+        // text and the file path, and its arguments are kept in the arena.
+        // This function will write an error message to diag if the line of
+        // assembly does not match any code macro and the returned asm line
+        // will have ASM_INVALID for each of its data members.
+		asm_line parse_asm(char* line, size_t len, std::string_view text, \
+                           std::string_view file_path, arena& storage, \
+                           std::ostream& diag) const;
 	
-		// This function takes in an operation name and an operand as string
-		// objects  and returns its corresponding code macro. If an invalid 
-        // operand or operation name is passed in, this function will return an
-        // invalid code macro and display an error message.
-		code_macro code_mac(std::string op_name, std::string operand);
+		// This function takes in an operation name, an operand and arguments
+        // to update that hold OP_MAX_ARGS, and returns a pointer to its
+        // corresponding code macro, updating the arguments and their number
+        // with the values matched from the operand. If an invalid operand or
+        // operation name is passed in, this function will return NULL.
+		const code_macro* code_mac(std::string_view op_name, \
+                                   std::string_view operand, op_arg* args, \
+                                   size_t& num_args) const;
 
         // Technically these are helper functions but are useful for other 
         // objects.
 		// This function takes in a string and returns a vector that is the 
 		// strings separated by spaces. 
-		std::vector<std::string> split_by_spaces(const std::string& str);
+		std::vector<std::string> split_by_spaces(const std::string& str) const;
         // This function returns the input but all lowercase and stripped of 
         // white space.
-        std::string strip_and_lower(std::string& input);
+        std::string strip_and_lower(const std::string& input) const;
 
         // Accessors	
-		std::vector<size_t> word_sizes();
-		std::vector<size_t> mem_sizes();
-		size_t harv_not_princ();
+		const std::vector<size_t>& word_sizes(void) const;
+		const std::vector<size_t>& mem_sizes(void) const;
+		size_t harv_not_princ(void) const;
+        // The path to the user function file as written in the ISA file.
+        const std::string& user_source_path(void) const;
+        // A hash of the ISA file and its user library, any change to either
+        // changes it.
+        uint64_t fingerprint(void) const;
+        // The index of a code macro of this ISA, and the code macro at an
+        // index or NULL if there is none. Indices are the same every time the
+        // same ISA is loaded.
+        size_t macro_index(const code_macro* macro) const;
+        const code_macro* macro_at(size_t index) const;
+        const isa_load_times& load_times(void) const;
+        // The shorter forms a code macro may be relaxed to, smallest first,
+        // from the relaxation lines of the ISA file. Empty if the code macro
+        // can not be relaxed.
+        const std::vector<relax_form>& relax_forms(const code_macro* macro) \
+                                                   const;
+        // The number of operand templates tried by code_mac so far.
+        uint64_t match_attempts(void) const;
+        // Whether the bytes of each unit of an instruction are written least
+        // significant first, and the size of the unit in bits, from the byte
+        // order line of the ISA file. Big endian by default.
+        bool little_endian(void) const;
+        size_t endian_unit_bits(void) const;
 		
 	// Private usage only.
 	private:
@@ -74,16 +135,55 @@ class isa {
 		size_t harv_not_princ_;
 		// Holds the order of elements and delimiters in a line of assembly.
 		std::vector<std::string> style_;
-		// Maps operation names to code macros.
-		std::unordered_multimap<std::string, code_macro> code_map_;
+        // Splits lines of assembly as described by the style.
+        line_lexer lexer_;
+		// All code macros, the overloads of each operation name are contiguous
+		// and in the order they are tried, most specific first.
+		std::vector<code_macro> macros_;
+        // The operation name of each code macro while the ISA file is parsed.
+        std::vector<std::string> macro_names_;
+        // The first code macro and number of code macros of each operation
+        // name, indexed by the mnemonic table.
+        std::vector<std::pair<size_t, size_t>> overloads_;
+        // Maps operation names to their index in overloads_.
+        mnemonic_table mnemonics_;
         // The file path for the user functions;
         std::string user_function_path_;
+        // The path to the user function file the library is built from.
+        std::string user_source_path_;
+        // The user library, opened once for the lifetime of the isa.
+        std::unique_ptr<user_lib> user_lib_;
+        // Whether the user library uses the binary encoder ABI.
+        bool binary_abi_;
+        uint64_t fingerprint_;
+        isa_load_times load_times_;
+        // Counted from every thread matching lines.
+        mutable std::atomic<uint64_t> match_attempts_;
+        // Maps user function names that could not be resolved to the ISA file
+        // lines that use them.
+        std::unordered_map<std::string, std::vector<size_t>> unresolved_lines_;
+        // The relaxation lines of the ISA file as their operation names, range
+        // and line number, kept until the code macros are grouped.
+        struct relax_line {
+            std::string long_name;
+            std::string short_name;
+            int64_t min;
+            int64_t max;
+            size_t line_num;
+        };
+        std::vector<relax_line> relax_lines_;
+        // The shorter forms of each code macro, indexed by code macro.
+        std::vector<std::vector<relax_form>> relax_forms_;
+        bool little_endian_;
+        size_t endian_unit_bits_;
 
 		// Helper functions.
-        // This file takes in a path to a file and compiles it to a shared 
-        // library. If The file can not be compiled an error message is 
-        // displayed and the program exits.
-        void compile_to_shared_lib(const std::string& source_file);
+        // This file takes in a path to a file and a library cache and compiles
+        // the file to a shared library unless it is already cached, then finds
+        // which ABI the library uses. If The file can not be compiled or its
+        // ABI version is not supported an error message is displayed.
+        void compile_to_shared_lib(const std::string& source_file, \
+                                   lib_cache& user_lib_cache);
 
         // This function takes in the isa file object and the isa file path and 
         // updates the memory data members.
@@ -93,37 +193,46 @@ class isa {
         // This function takes in a vector of strings and returns true or false
         // the vector represents valid elements and delimiters for the style 
         // data member.   
-        bool valid_style(std::vector<std::string> style); 
+        bool valid_style(const std::vector<std::string>& style) const;
                                 
 		// This function takes in a code macro line from the ISA file as a
 		// vector of strings and the isa file path as a string and a line 
         // number as an integer and parses the data updating the code map data 
         // member. If any of the data is invalid an error message is displayed.
-		void parse_isa_code_macro(std::vector<std::string> isa_line_data, \
-                                  std::string isa_file_path, size_t line_num);
-
-        // This function takes in the name of a dynamically linked library and 
-        //  function name, both as strings and returns the function pointer to
-        // the function.
-        code_macro::func_ptr load_function(const std::string& lib_name, \
-                            const std::string& func_name);
-
-        // This function takes in a style element and a reference element as 
-        // strings, and also takes in an integer cutoff value, and it takes in 
-        // and modifies a status variable and a line variable. If the element 
-        // matches the type of element the reference is, the delimiter from
-        // the original element is used to update the status variable using the
-        // line so long as the delimiter is before the cutoff.
-        void element_check(std::string element, std::string ref, \
-                           std::string& status, std::string& line, \
-                           size_t cutoff);
-        // This function takes an operand template as a vector of strings and a
-        // string operand that gets modified and determines if they match. If 
-        // they do a vector of strings is returned with the string arguments, an
-        // empty string means the instruction has no arguments. If they don't 
-        // then the instructions operand template doesn't match and an empty 
-        // vector is returned.
-        std::vector<std::string> op_match(std::vector<std::string> op_temp, \
-                                          std::string op);
+		void parse_isa_code_macro(const std::vector<std::string>& \
+                                  isa_line_data, \
+                                  const std::string& isa_file_path, \
+                                  size_t line_num);
+
+        // This function takes in a relaxation line from the ISA file as a
+        // vector of strings, the isa file path and a line number and keeps the
+        // line until the code macros are grouped. If any of the data is
+        // invalid an error message is displayed.
+        void parse_isa_relax(const std::vector<std::string>& isa_line_data, \
+                             const std::string& isa_file_path, \
+                             size_t line_num);
+
+        // This function takes in a byte order line from the ISA file as a
+        // vector of strings, the isa file path and a line number and sets the
+        // byte order of the output. If any of the data is invalid an error
+        // message is displayed.
+        void parse_isa_endian(const std::vector<std::string>& isa_line_data, \
+                              const std::string& isa_file_path, \
+                              size_t line_num);
+
+        // This function takes in the isa file path and pairs each overload of
+        // the long operation of every relaxation line with the overload of the
+        // short operation that has the same operand template and fewer bits.
+        // An error message is displayed for lines that pair no overloads.
+        void build_relax_forms(const std::string& isa_file_path);
+
+        // This function takes in the isa file path and displays one error
+        // message listing every user function that could not be resolved.
+        // Returns true if all functions were resolved.
+        bool report_unresolved(const std::string& isa_file_path);
+
+        // This function groups and orders the code macros of every operation
+        // name and builds the mnemonic table over the operation names.
+        void build_overloads(void);
 };
 #endif // ISA_HPP
@@ -0,0 +1,74 @@
+// lib_cache.hpp
+// Include file for the lib_cache class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <filesystem>
+#include <unordered_set>
+
+#ifndef LIB_CACHE_HPP
+#define LIB_CACHE_HPP
+
+// Constants.
+const std::string LIB_CACHE_INVALID = "";
+
+// A content hashed build cache for ISA user libraries. A user function file is
+// compiled once into the cache directory under the hash of its contents, the
+// headers it includes with quotes, the ABI header, the path and version of the
+// compiler and the compiler flags, so later runs load the cached shared
+// library without invoking the compiler. Libraries are compiled with the GenA
+// include directory on the include path.
+class lib_cache {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Takes in the cache directory as a string and whether every library
+        // should be rebuilt even if it is cached. An empty cache directory
+        // uses the default cache directory.
+		lib_cache(std::string cache_dir, bool rebuild);
+
+		// Destructor.
+		~lib_cache();
+
+		// Public Methods
+        // This function takes in the path to a user function file and returns
+        // the path to its compiled shared library, compiling it only if it is
+        // not already cached. If the file can not be read or compiled an error
+        // message is displayed and LIB_CACHE_INVALID is returned.
+        std::string shared_lib(const std::string& source_file);
+
+        // Accessors
+        std::string cache_dir(void) const;
+
+	// Private usage only.
+	private:
+		// Private data members.
+        // The directory cached libraries are stored in.
+        std::string cache_dir_;
+        // Whether to ignore cached libraries and always compile.
+        bool rebuild_;
+
+        // Helper functions
+        // This function returns the default cache directory.
+        static std::string default_cache_dir(void);
+        // This function takes in a hash and a string and returns the hash
+        // updated with the string.
+        static uint64_t hash(uint64_t seed, const std::string& data);
+        // This function takes in a hash, the path and contents of a source
+        // file and the files already hashed, and returns the hash updated with
+        // every file the source includes with quotes that is found next to it
+        // or in the GenA include directory, recursively.
+        static uint64_t hash_includes(uint64_t seed, \
+                                      const std::filesystem::path& path, \
+                                      const std::string& contents, \
+                                      std::unordered_set<std::string>& seen);
+        // This function returns the resolved path and the version of the
+        // compiler, found once per process.
+        static const std::string& compiler_identity(void);
+};
+
+#endif // LIB_CACHE_HPP
@@ -0,0 +1,79 @@
+// line_lexer.hpp
+// Include file for the line_lexer class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef LINE_LEXER_HPP
+#define LINE_LEXER_HPP
+
+// Constants.
+// The line elements in the order of line_lexer element kinds.
+const std::vector<std::string> STYLE_ELEMENTS = {"label", "op_name", "operand"};
+
+// The elements of a line of assembly as slices of the lexed line.
+struct lexed_line {
+    std::string_view label;
+    std::string_view op_name;
+    std::string_view operand;
+};
+
+// Splits lines of assembly into their label, operation name and operand as
+// described by the style line of an ISA file. A line is lexed in one pass
+// over a buffer owned by the caller, and the elements are lowercased and
+// stripped of white space in place so lexing never allocates.
+class line_lexer {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Creates a lexer that finds no elements.
+		line_lexer();
+		// Takes in a valid style as a vector of strings, each an element name
+        // followed by its delimiter.
+		line_lexer(const std::vector<std::string>& style);
+
+		// Destructor.
+		~line_lexer();
+
+		// Public Methods
+        // This function takes in a line of assembly as a writable buffer and
+        // its length, and updates the lexed line with its elements. The buffer
+        // is modified in place and the elements point into it. Returns false
+        // if the line has no elements.
+        bool lex(char* line, size_t len, lexed_line& out) const;
+
+	// Private usage only.
+	private:
+        // Kinds of elements in a line.
+        enum element_kind {
+            ELEMENT_LABEL,
+            ELEMENT_OP_NAME,
+            ELEMENT_OPERAND,
+            NUM_ELEMENTS
+        };
+
+		// Private data members.
+        // The element kinds in the order they appear in a line.
+        element_kind order_[NUM_ELEMENTS];
+        // The delimiter ending each element in order_.
+        char delims_[NUM_ELEMENTS];
+        // The number of elements in the style.
+        size_t num_elements_;
+
+        // Helper functions
+        // This function takes in a line, a start position, the line length and
+        // a delimiter and returns the position of the first delimiter at or
+        // after the start, or the line length if there is none.
+        static size_t find(const char* line, size_t start, size_t len, \
+                           char delim);
+        // This function takes in a slice of a line, lowercases it and removes
+        // its white space in place, and returns the resulting slice.
+        static std::string_view normalize(char* begin, char* end);
+};
+
+#endif // LINE_LEXER_HPP
@@ -0,0 +1,57 @@
+// listing_writer.hpp
+// Include file for the listing_writer class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <ostream>
+
+#ifndef LISTING_WRITER_HPP
+#define LISTING_WRITER_HPP
+
+// Writes the listing of an assembled program. Each encoded instruction is
+// listed as its word address and value in lowercase hex, padded to five
+// digits, followed by its assembly line, and every other line is listed as
+// its text alone. Lines are formatted into a buffer that is written to the
+// file in large chunks.
+class listing_writer {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Takes in the stream the listing is written to.
+		listing_writer(std::ostream& file);
+
+		// Destructor.
+		~listing_writer();
+
+		// Public Methods
+        // This function takes in the word address of an instruction, its
+        // encoded value and its assembly line and lists it.
+        void add_code(size_t word_address, size_t value, \
+                      std::string_view text);
+        // This function takes in an assembly line without an instruction and
+        // lists it.
+        void add_text(std::string_view text);
+        // This function writes what is still buffered to the file. Returns
+        // false if the stream failed.
+        bool finish(void);
+
+	// Private usage only.
+	private:
+		// Private data members.
+        std::ostream& file_;
+        std::string buffer_;
+
+        // Helper functions
+        // This function takes in a value and appends it in hex, padded with
+        // zeros to the listing width.
+        void append_hex(size_t value);
+        // This function writes the buffer to the file once it is full.
+        void write_full(void);
+};
+
+#endif // LISTING_WRITER_HPP
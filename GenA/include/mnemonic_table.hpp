@@ -0,0 +1,66 @@
+// mnemonic_table.hpp
+// Include file for the mnemonic_table class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef MNEMONIC_TABLE_HPP
+#define MNEMONIC_TABLE_HPP
+
+// Constants.
+const size_t MNEMONIC_NONE = std::string::npos;
+
+// A perfect hash table over the fixed set of operation names of an ISA. It is
+// built once when the ISA file is parsed using hash and displace: names are
+// hashed into buckets and each bucket gets a displacement that places all of
+// its names in free slots. A lookup is two hashes and one compare, is case
+// insensitive and never allocates.
+class mnemonic_table {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Creates an empty table.
+		mnemonic_table();
+
+		// Destructor.
+		~mnemonic_table();
+
+		// Public Methods
+        // This function takes in a list of distinct operation names and builds
+        // the table, the index of a name in the list is what find returns for
+        // it.
+        void build(const std::vector<std::string>& names);
+        // This function takes in an operation name in any case and returns its
+        // index, or MNEMONIC_NONE if it is not in the table.
+        size_t find(std::string_view name) const;
+
+	// Private usage only.
+	private:
+        // A slot of the table, empty slots have an index of MNEMONIC_NONE.
+        struct slot {
+            uint32_t name_offset;
+            uint32_t name_len;
+            size_t index;
+        };
+
+		// Private data members.
+        // The slots, a power of two long.
+        std::vector<slot> slots_;
+        // The displacement of each bucket.
+        std::vector<uint32_t> displacements_;
+        // All names in lowercase, back to back.
+        std::string names_;
+
+        // Helper functions
+        // This function takes in a name and a seed and returns the case
+        // insensitive hash of the name.
+        static uint32_t hash(std::string_view name, uint32_t seed);
+};
+
+#endif // MNEMONIC_TABLE_HPP
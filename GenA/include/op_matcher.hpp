@@ -0,0 +1,99 @@
+// op_matcher.hpp
+// Include file for the op_matcher class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "gena_abi.h"
+#include "symbol_pool.hpp"
+
+#ifndef OP_MATCHER_HPP
+#define OP_MATCHER_HPP
+
+// Constants.
+// Operand template elements.
+const std::string SYMBOL = "Sym";
+const std::string VALUE = "Val";
+const std::string PC = "$Val";
+// The most arguments an operand template can produce.
+const size_t OP_MAX_ARGS = 8;
+static_assert(OP_MAX_ARGS <= GENA_MAX_OPERANDS, \
+              "Every argument must fit in the encoder operands.");
+const size_t OP_NO_MATCH = std::string::npos;
+
+// An argument matched from an operand. Values are the slice of the operand at
+// pos with length len, program counter slots take no text from the operand.
+// The symbol is the id of the value in the symbol pool of the lines, left
+// SYMBOL_NONE by matching.
+struct op_arg {
+    size_t pos;
+    size_t len;
+    bool pc;
+    uint32_t symbol;
+};
+
+// An operand template compiled into a small matcher program when the ISA is
+// loaded. The program is a list of literal symbols, value captures and program
+// counter slots that is run over an operand without allocating.
+class op_matcher {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Takes in an operand template as a vector of strings and compiles it.
+        // Symbols are matched in lowercase since operands are lowercased.
+		op_matcher(const std::vector<std::string>& operand_template);
+
+		// Destructor.
+		~op_matcher();
+
+		// Public Methods
+        // This function takes in a lowercase operand without white space and
+        // an array of at least OP_MAX_ARGS arguments, and fills the arguments
+        // in template order if the operand matches. Returns the number of
+        // arguments, or OP_NO_MATCH if the operand does not match.
+        size_t match(std::string_view op, op_arg* args) const;
+
+        // Accessors
+        // The first character of the template if it starts with a symbol, 0
+        // if it starts with a value. An operand can only match if it starts
+        // with this character.
+        char lead(void) const;
+        // The number of symbol characters in the template, templates with
+        // more symbols are more specific.
+        size_t num_symbol_chars(void) const;
+        // Whether the template compiled without errors.
+        bool valid(void) const;
+
+	// Private usage only.
+	private:
+        // Kinds of steps in the matcher program.
+        enum step_kind : uint8_t {
+            STEP_SYMBOL,
+            STEP_VALUE,
+            STEP_PC
+        };
+        // One step, symbols are the slice of symbols_ at offset with length
+        // len.
+        struct step {
+            step_kind kind;
+            uint32_t offset;
+            uint32_t len;
+        };
+
+		// Private data members.
+        // The matcher program.
+        std::vector<step> steps_;
+        // The text of all symbols in the program.
+        std::string symbols_;
+        // The first character of the template if it starts with a symbol.
+        char lead_;
+        // Whether the template compiled without errors.
+        bool valid_;
+};
+
+#endif // OP_MATCHER_HPP
@@ -0,0 +1,133 @@
+// segment_image.hpp
+// Include file for the segment_image class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include "asm_line.hpp"
+#include "code_macro.hpp"
+#include "op_matcher.hpp"
+
+#ifndef SEGMENT_IMAGE_HPP
+#define SEGMENT_IMAGE_HPP
+
+// The program image of a segment keyed by address. Placed lines are stored as
+// parallel columns, one entry per line in the order they are placed, so the
+// passes over the program stream through the hot columns (address, size,
+// code macro and arguments) and only touch the cold lines for listings and
+// diagnostics. Each contiguous run of addresses (started by the beginning of
+// the program or a code location pseudo operation) is indexed by its start
+// address in a sparse map. Placing a line at the end of the current run is
+// O(1) amortized and memory only tracks the lines actually placed, never the
+// address span.
+class segment_image {
+	// Publicly usable.
+	public:
+		// Constructor.
+        // Creates an empty image.
+		segment_image();
+
+		// Destructor.
+		~segment_image();
+
+		// Public Methods
+        // This function takes in an address in bits, a line of assembly and
+        // its size in bits and places the line at that address. The line is
+        // kept by pointer and must outlive the image. Returns false if the
+        // line overlaps code that has already been placed, the line is still
+        // kept in the image.
+        bool place(size_t address, const asm_line& line, size_t num_bits);
+        // This function takes in the index of a line, a code macro and a size
+        // in bits no larger than the size the line was placed with, and
+        // changes the code macro and size of the line. The addresses of the
+        // lines after it are not moved until the image is reflowed. Lines are
+        // only resized before the image is ordered by address.
+        void resize(size_t line, const code_macro* macro, size_t num_bits);
+        // This function moves the lines after every line resized since the
+        // last reflow so each run is contiguous again. Runs keep their start
+        // addresses and only the part of a run after its first resized line
+        // is moved.
+        void reflow(void);
+        // This function reorders the columns so the lines are in address
+        // order. Lines with the same address stay in the order they were
+        // placed.
+        void order_by_address(void);
+
+        // Accessors
+        // The columns of the image, indexed by line.
+        const std::vector<size_t>& addresses(void) const;
+        const std::vector<uint32_t>& sizes(void) const;
+        const std::vector<const code_macro*>& macros(void) const;
+        // The start of the operand of each line, which the arguments of the
+        // line are slices of, and the arguments and their number.
+        const std::vector<const char*>& operands(void) const;
+        const std::vector<const op_arg*>& arguments(void) const;
+        const std::vector<uint8_t>& num_arguments(void) const;
+        const std::vector<const asm_line*>& lines(void) const;
+        size_t size(void) const;
+
+	// Private usage only.
+	private:
+        // A contiguous run of addresses and the lines placed in it.
+        struct run {
+            size_t start;
+            size_t end;
+            size_t first;
+            size_t count;
+            // The first line resized since the last reflow, or
+            // std::string::npos if none was.
+            size_t resized;
+        };
+
+		// Private data members.
+        // The columns of every placed line.
+        std::vector<size_t> addresses_;
+        std::vector<uint32_t> sizes_;
+        std::vector<const code_macro*> macros_;
+        std::vector<const char*> operands_;
+        std::vector<const op_arg*> arguments_;
+        std::vector<uint8_t> num_arguments_;
+        std::vector<const asm_line*> lines_;
+        // All runs in the order they were started.
+        std::vector<run> runs_;
+        // The runs with a line resized since the last reflow.
+        std::vector<size_t> resized_runs_;
+        // Maps the start address of each run to its index in runs_.
+        std::multimap<size_t, size_t> run_index_;
+        // The address ranges of the finished runs that hold code, merged so
+        // no two overlap or touch. Maps the start of each range to its end.
+        std::map<size_t, size_t> covered_;
+        // The start address of the run after the current one, the current run
+        // may not grow past it.
+        size_t limit_;
+        // The end of the runs the current one started inside of, the current
+        // run may not place code before it.
+        size_t floor_;
+
+        // Helper functions
+        // This function takes in the address a run starts at and sets the
+        // first address at or after it that is not inside a run already
+        // started, and the start of the next run after it that holds code.
+        void run_bounds(size_t address, size_t& floor, size_t& limit) const;
+        // This function takes in the start and end of a finished run and adds
+        // its addresses to the covered ranges.
+        void cover(size_t start, size_t end);
+        // This function takes in a column and the index each line is moved
+        // from, in the new order, and reorders the column.
+        template <typename T>
+        static void permute(std::vector<T>& column, \
+                            const std::vector<size_t>& order) {
+            std::vector<T> moved;
+            moved.reserve(column.size());
+            for (size_t i : order) {
+                moved.push_back(column[i]);
+            }
+            column.swap(moved);
+        }
+};
+
+#endif // SEGMENT_IMAGE_HPP
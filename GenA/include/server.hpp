@@ -0,0 +1,218 @@
+// server.hpp
+// Include file for the server class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sys/types.h>
+#include "lib_cache.hpp"
+#include "isa.hpp"
+#include "source_cache.hpp"
+#include "chunk_runner.hpp"
+
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+// Constants.
+// The version of the messages between clients and servers.
+const uint32_t SERVER_PROTOCOL_VERSION = 1;
+
+// An ISA kept loaded by a server with the files parsed with it.
+struct warm_isa {
+    // The absolute paths of the ISA file, the cache directory and the user
+    // function file, and the stamps of the files when they were loaded.
+    std::string isa_path;
+    std::string cache_dir;
+    std::string source_path;
+    file_stamp isa_stamp;
+    file_stamp source_stamp;
+    std::unique_ptr<lib_cache> cache;
+    std::unique_ptr<isa> cpu_isa;
+    std::unique_ptr<source_cache> sources;
+};
+
+// Serves assembly jobs on a Unix socket, keeping ISAs and the files parsed with
+// them loaded between jobs. Every job is run in a child process forked from the
+// server, so it starts with everything the server has loaded and any error that
+// ends it only ends the job. A client passes its working directory, its
+// arguments and its standard output and error to the server, the job writes to
+// them directly and the client gets back its exit status. After a job a worker
+// thread loads the ISA and parses the files the job used while the server goes
+// on serving, and adds them to the server when they are ready, so the next job
+// that uses them finds them loaded. Anything loaded is used again only while
+// its files are unchanged. A server can also watch a single job, running it
+// again in the same way whenever one of its files changes.
+class server {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Takes in the path of the socket to serve on and the number of
+        // threads used to parse files.
+		server(std::string socket_path, size_t jobs);
+
+		// Destructor.
+		~server();
+
+        // A server owns its socket and loaded ISAs.
+        server(const server&) = delete;
+        server& operator=(const server&) = delete;
+
+		// Public Methods
+        // This function takes in a function that runs a job given its
+        // arguments and returns its exit status, and serves jobs until the
+        // server is interrupted or terminated. Returns false and displays an
+        // error message if the socket can not be served on.
+        bool serve(const std::function<int(int, char**)>& run_job);
+        // This function takes in the arguments of a job, the paths to watch
+        // if the job reports none and the job function, and runs the job
+        // every time a file it used, its ISA file or its user function file
+        // changes, until the server is interrupted or terminated. Returns
+        // false and displays an error message if the files can not be
+        // watched.
+        bool watch(std::vector<std::string> args, \
+                   const std::vector<std::string>& paths, \
+                   const std::function<int(int, char**)>& run_job);
+        // This function takes in the path to an ISA file and a cache
+        // directory and returns the ISA loaded from them if it is loaded and
+        // unchanged, otherwise NULL. Relative paths are relative to the
+        // working directory of the job.
+        warm_isa* find(const std::string& isa_path, \
+                       const std::string& cache_dir);
+        // This function takes in the path to the ISA file and cache directory
+        // a job used and the absolute paths of the files it parsed, and
+        // reports them to the server to load after the job. Does nothing
+        // outside of a job.
+        void report(const std::string& isa_path, const std::string& cache_dir, \
+                    const std::vector<std::string>& source_paths);
+        // This function takes in the path of a server socket, the arguments of
+        // a job and an exit status to update, and runs the job on the server.
+        // Returns false if there is no server or it did not run the job.
+        static bool request(const std::string& socket_path, \
+                            const std::vector<std::string>& args, \
+                            int& status);
+
+	// Private usage only.
+	private:
+        // A job being run by a child process.
+        struct job {
+            pid_t pid;
+            // The connection to the client and the read end of the pipe the
+            // child reports on.
+            int client;
+            int report;
+            std::string cwd;
+            std::string report_text;
+        };
+        // The files a watch waits on. The directories of the files are
+        // watched so files that editors replace, or that do not exist yet,
+        // are still seen.
+        struct watch_set {
+            // The watch of each directory and the names watched in each.
+            std::unordered_map<std::string, int> dirs;
+            std::unordered_map<int, std::unordered_set<std::string>> names;
+        };
+
+		// Private data members.
+        std::string socket_path_;
+        // The working directory of the server.
+        std::string cwd_;
+        // Parses files after jobs.
+        chunk_runner runner_;
+        int listen_fd_;
+        // The write end of the report pipe in a job, -1 in the server.
+        int report_fd_;
+        // Whether files parsed after jobs are copied, which they are when
+        // serving.
+        bool copy_files_;
+        std::vector<std::unique_ptr<warm_isa>> isas_;
+        std::vector<job> jobs_;
+        // Loads what jobs reported while serving. The working directory and
+        // report of each finished job wait in order to be loaded.
+        std::thread warmer_;
+        std::deque<std::pair<std::string, std::string>> pending_;
+        bool warmer_stopping_;
+        // Guards the loaded ISAs and the waiting reports. It is held while
+        // jobs are forked so a job never starts with an ISA half changed.
+        std::mutex warm_mutex_;
+        std::condition_variable warm_ready_;
+
+        // Helper functions
+        // This function installs the handlers of the signals that stop the
+        // server.
+        static void handle_stop_signals(void);
+        // This function takes in the arguments of a job and the job function,
+        // and runs the job in a child process. It never returns.
+        void run_child(std::vector<std::string>& args, \
+                       const std::function<int(int, char**)>& run_job);
+        // This function takes in an inotify descriptor, the absolute paths of
+        // files, a watch set, the time a job started in nanoseconds and
+        // whether a file changed, and makes the set watch exactly the files.
+        // A file that was not watched before and was modified after the job
+        // started sets changed. Returns false and displays an error message
+        // if none of the files can be watched.
+        bool update_watches(int notify_fd, \
+                            const std::vector<std::string>& paths, \
+                            watch_set& watched, int64_t since_ns, \
+                            bool& changed);
+        // This function takes in an inotify descriptor, a watch set and
+        // whether a file already changed, and waits until a watched file is
+        // written, created, moved or deleted. Returns false if the server is
+        // stopped first or the files can not be watched.
+        bool wait_for_change(int notify_fd, const watch_set& watched, \
+                             bool changed);
+        // This function takes in a connection from a client and the job
+        // function, reads the job and forks a child to run it. The child
+        // never returns.
+        void start_job(int client, \
+                       const std::function<int(int, char**)>& run_job);
+        // This function takes in a job whose child has finished, sends its
+        // exit status to the client and passes what it reported to the
+        // worker to load.
+        void finish_job(job& done);
+        // This function loads the reports of finished jobs in order until
+        // the worker is stopped. It is run by the worker thread.
+        void run_warmer(void);
+        // This function takes in a working directory and the text of a job
+        // report and loads the ISA and parses the files in it. The ISA is
+        // taken out of the loaded ISAs while its files are parsed and added
+        // back after.
+        void warm(const std::string& cwd, const std::string& report_text);
+        // This function takes in the absolute path to an ISA file and a cache
+        // directory and removes the ISA loaded from them from the loaded
+        // ISAs. Returns the ISA if it is unchanged, otherwise NULL.
+        std::unique_ptr<warm_isa> take(const std::string& isa_path, \
+                                       const std::string& cache_dir);
+        // This function takes in the path to an ISA file and a cache
+        // directory and loads the ISA in a child process. Returns true if it
+        // loads without errors.
+        bool loads(const std::string& isa_path, const std::string& cache_dir);
+        // This function takes in a loaded ISA and returns whether its ISA
+        // file and user function file are unchanged since it was loaded.
+        static bool unchanged(const warm_isa& entry);
+        // This function takes in a path and returns it absolute, or empty if
+        // it is empty.
+        static std::string absolute(const std::string& path);
+        // These functions take in a file descriptor and a buffer and read or
+        // write all of it. Return false if the connection ends or fails.
+        static bool read_all(int fd, void* data, size_t len);
+        static bool write_all(int fd, const void* data, size_t len);
+        // These functions take in a file descriptor and read or write a
+        // string prefixed by its length. Return false on failure.
+        static bool read_string(int fd, std::string& str);
+        static bool write_string(int fd, const std::string& str);
+};
+
+#endif // SERVER_HPP
@@ -0,0 +1,176 @@
+// source_cache.hpp
+// Include file for the source_cache class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include "asm_line.hpp"
+#include "isa.hpp"
+#include "source_manager.hpp"
+#include "chunk_runner.hpp"
+#include "build_db.hpp"
+#include "symbol_pool.hpp"
+#include "arena.hpp"
+
+#ifndef SOURCE_CACHE_HPP
+#define SOURCE_CACHE_HPP
+
+// A logical line of a file after parsing, lines joined by continue symbols
+// are one logical line. Pseudo operations are left unparsed for the first
+// pass to handle in order.
+struct parsed_line {
+    // The number of the last physical line of the logical line.
+    size_t line_num;
+    // Whether the line is a pseudo operation.
+    bool pseudo;
+    // The line in the writable copy of the file and its length.
+    char* work;
+    size_t len;
+    // The original text of the line.
+    std::string_view text;
+    asm_line line;
+    // Any error message from parsing the line.
+    std::string diagnostic;
+};
+
+// What identifies the version of a file on disk without reading it.
+struct file_stamp {
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    int64_t mtime_ns;
+
+    bool operator==(const file_stamp& other) const;
+};
+
+// Keeps the parsed lines of assembly files for one ISA. Files are keyed by
+// their absolute path and parsed the first time they are loaded. A file is
+// parsed again only when it has changed, which is checked by its stamp and,
+// when the stamp changes, by a hash of its contents so touched files are not
+// parsed again. Files can also be restored from a build database and
+// recorded in one. Parsed lines point into the cached text, which lives until
+// the lines are released. The labels and arguments of every line are interned
+// in one symbol pool, so ids are shared by all files of the cache.
+class source_cache {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Takes in the ISA lines are parsed with, which must outlive the
+        // cache, and whether files are copied rather than mapped while they
+        // are cached.
+		source_cache(const isa& cpu_isa, bool copy_files = false);
+
+		// Destructor.
+		~source_cache();
+
+        // Parsed lines point into text owned by exactly one cache.
+        source_cache(const source_cache&) = delete;
+        source_cache& operator=(const source_cache&) = delete;
+
+		// Public Methods
+        // This function takes in the path to an assembly file, a runner to
+        // parse it with and a build database or NULL, and returns the parsed
+        // lines of the file. A file that is not cached or has changed is
+        // restored from the database if it is recorded there with the same
+        // contents, otherwise it is parsed. Returns NULL if the file can not
+        // be opened. The lines stay valid until they are released after the
+        // file changes.
+        const std::vector<parsed_line>* load(const std::string& path, \
+                                             const chunk_runner& runner, \
+                                             const build_db* db = NULL);
+        // This function takes in the paths to the files of a program and a
+        // build database, records the loaded files that are not recorded with
+        // the same contents and forgets the files of other programs. Returns
+        // true if the database changed.
+        bool record(const std::vector<std::string>& paths, build_db& db) const;
+        // This function releases the lines of files that have been parsed
+        // again since they changed.
+        void release_stale(void);
+        // This function forgets which files have been parsed.
+        void clear_parsed_paths(void);
+        // This function takes in a path and updates the stamp of the file.
+        // Returns false if the file does not exist.
+        static bool stamp(const std::string& path, file_stamp& out);
+
+        // Accessors
+        // The absolute paths of the files parsed or restored by this cache,
+        // in the order they were loaded.
+        const std::vector<std::string>& parsed_paths(void) const;
+        // The number of files restored from build databases.
+        size_t num_restored(void) const;
+        // The symbol pool lines are interned in.
+        symbol_pool& symbols(void);
+        const symbol_pool& symbols(void) const;
+
+	// Private usage only.
+	private:
+        // A cached file.
+        struct cached_file {
+            // The source manager id of the file, SOURCE_INVALID if it was
+            // restored.
+            size_t file;
+            // The path lines are from, as the file was first loaded.
+            std::string path;
+            file_stamp stamp;
+            uint64_t hash;
+            // The lexed file lines point into.
+            char* work;
+            size_t work_size;
+            // The lexed file and original text of a restored file.
+            std::string work_copy;
+            std::string text_copy;
+            std::vector<parsed_line> lines;
+            // The arguments of the lines, one arena for each chunk they were
+            // parsed in, freed with the file.
+            std::vector<arena> arenas;
+        };
+
+		// Private data members.
+        const isa& cpu_isa_;
+        // The text of every cached file.
+        source_manager sources_;
+        // The cached files keyed by absolute path.
+        std::unordered_map<std::string, std::unique_ptr<cached_file>> files_;
+        // Files replaced by a newer version that may still be in use.
+        std::vector<std::unique_ptr<cached_file>> stale_;
+        std::vector<std::string> parsed_paths_;
+        size_t num_restored_;
+        symbol_pool symbols_;
+
+        // Helper functions
+        // This function takes in a source manager file id, its cached file
+        // and a runner and updates the cached file with the logical lines of
+        // the file parsed. The file is split into lines in order, joining
+        // continued lines, then the lines are lexed and matched to code macros
+        // in chunks by the runner, each chunk keeping arguments in its own
+        // arena. Error messages are kept with their lines so they can be
+        // reported in order.
+        void parse_file(size_t file, cached_file& entry, \
+                        const chunk_runner& runner);
+        // This function takes in lines that were parsed or restored and
+        // interns them in order. Names are interned after the lines are
+        // parsed in chunks since the pool is not thread safe.
+        void intern_lines(std::vector<parsed_line>& lines);
+        // This function takes in the record of a file, a cached file to
+        // update and a runner, and restores the lines of the file from the
+        // record. Returns false if the record does not fit the ISA.
+        bool restore(const build_db::file_record& record, cached_file& entry, \
+                     const chunk_runner& runner) const;
+        // This function takes in the key of a cached file, the file and a
+        // build database and records the file in the database.
+        void record_file(const std::string& key, const cached_file& entry, \
+                         build_db& db) const;
+        // This function takes in a path and returns the key of its file.
+        static std::string key_of(const std::string& path);
+        // This function takes in text and returns its FNV-1a hash.
+        static uint64_t hash(std::string_view text);
+};
+
+#endif // SOURCE_CACHE_HPP
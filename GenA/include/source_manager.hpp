@@ -0,0 +1,104 @@
+// source_manager.hpp
+// Include file for the source_manager class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+
+#ifndef SOURCE_MANAGER_HPP
+#define SOURCE_MANAGER_HPP
+
+// Constants.
+const size_t SOURCE_INVALID = std::string::npos;
+
+// Owns the text of every assembly file read. Each file is mapped twice, read
+// only for the original text, which is what lines of assembly refer to for
+// listings and diagnostics, and copy on write for the working copy that lines
+// are lexed in, so only the pages lexing changes are ever copied. A manager
+// that copies its files, as a server does since a mapped file that is
+// truncated between jobs faults when it is read, first copies each file into
+// an anonymous file of its own and maps that the same way. Files that can not
+// be mapped, like pipes, are copied too. The start of every line is indexed
+// when the file is opened so line numbers can be found from offsets.
+class source_manager {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Takes in whether files are copied before they are mapped and
+        // creates a manager with no files.
+		source_manager(bool copy = false);
+
+		// Destructor.
+		~source_manager();
+
+        // Files are owned by exactly one manager.
+        source_manager(const source_manager&) = delete;
+        source_manager& operator=(const source_manager&) = delete;
+
+		// Public Methods
+        // This function takes in a file path and reads the file. Returns the
+        // id of the file, or SOURCE_INVALID if it can not be read.
+        size_t open(const std::string& path);
+        // This function takes in a file id and an offset into the file and
+        // returns the line number of the offset, starting at 1.
+        size_t line_of(size_t file, size_t offset) const;
+        // This function takes in a file id and a line number starting at 1
+        // and returns the original text of the line without its newline.
+        std::string_view line_text(size_t file, size_t line_num) const;
+        // This function takes in a file id and the offset and length of lines
+        // joined by continue symbols, and returns their original text with the
+        // continue symbols and newlines removed. The text is kept by the
+        // manager.
+        std::string_view join(size_t file, size_t offset, size_t len);
+        // This function takes in a file id and frees the file and the text
+        // of its joined lines. The id is not reused and must not be used
+        // again.
+        void close(size_t file);
+
+        // Accessors
+        // The original text of a file.
+        std::string_view text(size_t file) const;
+        // The writable copy of a file that lines are lexed in.
+        char* work(size_t file);
+        const std::string& path(size_t file) const;
+        size_t num_lines(size_t file) const;
+        size_t num_files(void) const;
+
+	// Private usage only.
+	private:
+        // A file read by the manager.
+        struct source_file {
+            std::string path;
+            // The original text and the writable copy, pointing into their
+            // mappings, or NULL if the file is empty.
+            const char* text;
+            char* work;
+            size_t size;
+            // The offset of the start of every line.
+            std::vector<size_t> line_starts;
+            // The text of joined lines.
+            std::deque<std::string> joined;
+        };
+
+		// Private data members.
+        // Whether files are copied before they are mapped.
+        bool copy_;
+        // Every file opened, indexed by id.
+        std::deque<source_file> files_;
+
+        // Helper functions
+        // This function takes in an open file descriptor and a file and maps
+        // the file twice into it. Returns false if it can not be mapped.
+        static bool map_file(int fd, source_file& file);
+        // This function takes in an open file descriptor, copies the file
+        // into an anonymous file and returns its descriptor, or -1 if it can
+        // not be copied.
+        static int copy_file(int fd);
+};
+
+#endif // SOURCE_MANAGER_HPP
@@ -0,0 +1,74 @@
+// symbol_pool.hpp
+// Include file for the symbol_pool class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef SYMBOL_POOL_HPP
+#define SYMBOL_POOL_HPP
+
+// Constants.
+// The id of no symbol.
+const uint32_t SYMBOL_NONE = UINT32_MAX;
+
+// Interns the names of symbols, giving each distinct name a dense id from 0
+// in the order they are first seen. Names are kept end to end in one buffer
+// and found through an open addressing table of ids, so an id stays valid and
+// names are never hashed again once interned. Not thread safe.
+class symbol_pool {
+	// Publicly usable.
+	public:
+		// Constructor.
+		symbol_pool();
+
+		// Destructor.
+		~symbol_pool();
+
+		// Public Methods
+        // This function takes in a name and returns its id, interning it if
+        // it is new.
+        uint32_t intern(std::string_view name);
+        // This function takes in a name and returns its id, or SYMBOL_NONE if
+        // it has not been interned.
+        uint32_t find(std::string_view name) const;
+        // This function takes in an id and returns its name. The name is valid
+        // until the next name is interned.
+        std::string_view name(uint32_t id) const;
+
+        // Accessors
+        // The number of names interned, one more than the largest id.
+        size_t size(void) const;
+
+	// Private usage only.
+	private:
+        // Where the name of an id is in the buffer and its hash.
+        struct name_slice {
+            size_t pos;
+            size_t len;
+            uint64_t hash;
+        };
+
+		// Private data members.
+        std::string names_;
+        std::vector<name_slice> slices_;
+        // The table of ids, SYMBOL_NONE for empty slots. Its size is a power
+        // of two kept at least twice the number of ids.
+        std::vector<uint32_t> slots_;
+
+        // Helper functions
+        // This function takes in a name and its hash and returns the slot
+        // holding its id, or the empty slot it would be put in.
+        size_t slot_of(std::string_view name, uint64_t hash) const;
+        // This function doubles the table and puts every id back in it.
+        void grow(void);
+        // This function takes in a name and returns its FNV-1a hash.
+        static uint64_t hash(std::string_view name);
+};
+
+#endif // SYMBOL_POOL_HPP
@@ -0,0 +1,71 @@
+// symbol_table.hpp
+// Include file for the symbol_table class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include "symbol_pool.hpp"
+
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+
+// What defined a symbol.
+enum symbol_kind {
+    SYMBOL_UNDEFINED,
+    SYMBOL_LABEL,
+    SYMBOL_VARIABLE,
+    SYMBOL_CONSTANT
+};
+
+// A defined symbol, with the index of the program file and the line that
+// defined it.
+struct symbol_entry {
+    size_t value;
+    symbol_kind kind;
+    size_t file;
+    size_t line;
+};
+
+// The symbols defined by a program, kept in one array indexed by the ids of
+// a symbol pool, so looking one up is indexing the array.
+class symbol_table {
+	// Publicly usable.
+	public:
+		// Constructor.
+		symbol_table();
+
+		// Destructor.
+		~symbol_table();
+
+		// Public Methods
+        // This function takes in an id and the symbol to define it as, and
+        // defines it. Returns false if it is already defined.
+        bool define(uint32_t id, const symbol_entry& entry);
+        // This function takes in the id of a defined symbol and a value and
+        // changes the value of the symbol, such as a label that moved.
+        void set_value(uint32_t id, size_t value);
+        // This function takes in an id and returns its symbol, or NULL if it
+        // is not defined.
+        const symbol_entry* find(uint32_t id) const {
+            if ((id >= entries_.size()) || \
+                (entries_[id].kind == SYMBOL_UNDEFINED)) {
+                return NULL;
+            }
+            return &entries_[id];
+        }
+
+        // Accessors
+        // The ids of the defined symbols in the order they were defined.
+        const std::vector<uint32_t>& defined(void) const;
+
+	// Private usage only.
+	private:
+		// Private data members.
+        std::vector<symbol_entry> entries_;
+        std::vector<uint32_t> defined_;
+};
+
+#endif // SYMBOL_TABLE_HPP
@@ -0,0 +1,57 @@
+// user_lib.hpp
+// Include file for the user_lib class.
+// Revision History:
+// 10/17/26 agent Initial Revision.
+
+// Included libraries.
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#ifndef USER_LIB_HPP
+#define USER_LIB_HPP
+
+// An ISA user library opened once for the lifetime of the object. Symbols are
+// resolved through a cache so each distinct function name is looked up once,
+// and names that can not be resolved are collected so they can be reported
+// together.
+class user_lib {
+	// Publicly usable.
+	public:
+		// Constructor.
+		// Takes in the path to a shared library and opens it. If the library
+        // can not be opened an error message is displayed and every symbol
+        // lookup fails.
+		user_lib(const std::string& lib_path);
+
+		// Destructor.
+        // Closes the library.
+		~user_lib();
+
+        // The library handle is owned by exactly one object.
+        user_lib(const user_lib&) = delete;
+        user_lib& operator=(const user_lib&) = delete;
+
+		// Public Methods
+        // This function takes in a function name and whether it is required
+        // and returns its address in the library, or NULL if it is not found.
+        // Missing required names are recorded in the unresolved list once.
+        void* symbol(const std::string& name, bool required = true);
+
+        // Accessors
+        bool is_open(void) const;
+        const std::vector<std::string>& unresolved(void) const;
+
+	// Private usage only.
+	private:
+		// Private data members.
+        // The handle returned by dlopen.
+        void* handle_;
+        // Maps every name looked up to its address, NULL if not found.
+        std::unordered_map<std::string, void*> symbols_;
+        // Names that could not be resolved in the order they were looked up.
+        std::vector<std::string> unresolved_;
+};
+
+#endif // USER_LIB_HPP
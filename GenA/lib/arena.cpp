@@ -0,0 +1,82 @@
+// arena.cpp
+// C++ file for the arena class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "arena.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstring>
+
+// Constructor.
+arena::arena() : pos_(NULL), end_(NULL), used_(0), reserved_(0) {}
+
+// Destructor
+arena::~arena() {};
+
+// Public functions.
+void* arena::allocate(size_t size, size_t align) {
+    // Use the current block if the value fits after its padding.
+    if (pos_ != NULL) {
+        char* start = align_up(pos_, align);
+        if (static_cast<size_t>(start - pos_) + size <= \
+            static_cast<size_t>(end_ - pos_)) {
+            pos_ = start + size;
+            used_ += size;
+            return start;
+        }
+    }
+    used_ += size;
+    // Large allocations take a block of their own so the current block keeps
+    // its free space.
+    if (size + align > ARENA_BLOCK_SIZE) {
+        return align_up(new_block(size + align), align);
+    }
+    char* block = new_block(ARENA_BLOCK_SIZE);
+    char* start = align_up(block, align);
+    pos_ = start + size;
+    end_ = block + ARENA_BLOCK_SIZE;
+    return start;
+}
+
+std::string_view arena::copy(std::string_view text) {
+    if (text.empty()) {
+        return std::string_view();
+    }
+    char* out = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(out, text.data(), text.size());
+    return std::string_view(out, text.size());
+}
+
+void arena::clear(void) {
+    blocks_.clear();
+    pos_ = NULL;
+    end_ = NULL;
+    used_ = 0;
+    reserved_ = 0;
+}
+
+// Accessors
+size_t arena::bytes_used(void) const {
+    return used_;
+}
+size_t arena::bytes_reserved(void) const {
+    return reserved_;
+}
+
+// Helper functions.
+char* arena::new_block(size_t size) {
+    blocks_.push_back(std::make_unique<char[]>(size));
+    reserved_ += size;
+    return blocks_.back().get();
+}
+
+char* arena::align_up(char* pos, size_t align) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(pos);
+    return pos + (((address + align - 1) & ~static_cast<uintptr_t>(align - 1)) \
+                  - address);
+}
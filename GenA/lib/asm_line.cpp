@@ -11,73 +11,150 @@
 #include "isa.hpp"
 #include <tuple>
 #include <functional>
-#include <code_macro.hpp>
+#include "code_macro.hpp"
+#include "op_matcher.hpp"
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <string_view>
+#include <charconv>
+#include <cctype>
+#include "gena_abi.h"
 
 
 
 // Constructor
-asm_line::asm_line(std::string origin_file_path, std::string text, \
-                 std::string label, std::string op_name, std::string operand) \
+asm_line::asm_line(std::string_view origin_file_path, std::string_view text, \
+                 std::string_view label, std::string_view op_name, \
+                 std::string_view operand, const code_macro* macro, \
+                 op_arg* arguments, size_t num_arguments) \
                     : origin_file_path_(origin_file_path), text_(text), \
-                    label_(label), op_name_(op_name), operand_(operand) {}
+                    label_(label), label_symbol_(SYMBOL_NONE), \
+                    op_name_(op_name), operand_(operand), macro_(macro), \
+                    arguments_(arguments), num_arguments_(num_arguments) {}
 
 // Destructor
 asm_line::~asm_line() {}
 
 // Public functions.
-size_t asm_line::size(isa cpu_isa) {
-    if (!operand_.empty()){
-        code_macro macro = cpu_isa.code_mac(op_name_, operand_);
-        return cpu_isa.code_mac(op_name_, operand_).num_inst_bits();
+size_t asm_line::size(void) const {
+    if (macro_ != NULL) {
+        return macro_->num_inst_bits();
     }
     else {
         return 0;
     }
 }
 
-// When the line is asked to assemble itself it locates its own code macro and 
-// looks to swap in any symbols in the arguments then sends it to the function.
-size_t asm_line::assemble(isa cpu_isa, \
-                          std::unordered_multimap<std::string, size_t> table,
-                          size_t pc) {
-    std::vector<std::string> args;   
-    std::vector<std::string> symbolic_args;   
-    size_t result;
-    code_macro macro = cpu_isa.code_mac(op_name_, operand_);
-    symbolic_args = macro.arguments;
-    for (std::string symbol : symbolic_args) {
-        if (symbol == PC) {
-            args.insert(args.begin(), std::to_string(pc));
+// When the line is asked to assemble itself it uses the code macro it was
+// matched to, swaps in any symbols and parses the rest of the arguments, then
+// sends them to the encoder.
+bool asm_line::assemble(const symbol_table& table, size_t pc, \
+                        uint64_t& out) const {
+    gena_operands ops;
+    return operands(table, pc, ops) && macro_->encode(ops, out);
+}
+
+void asm_line::intern(symbol_pool& pool) {
+    if (!label_.empty()) {
+        label_symbol_ = pool.intern(label_);
+    }
+    for (size_t i = 0; i < num_arguments_; i++) {
+        op_arg& arg = arguments_[i];
+        if (!arg.pc) {
+            arg.symbol = pool.intern(operand_.substr(arg.pos, arg.len));
+        }
+    }
+}
+
+bool asm_line::operands(const symbol_table& table, size_t pc, \
+                        gena_operands& ops) const {
+    return operands(macro_, operand_.data(), arguments_, num_arguments_, \
+                    table, pc, ops);
+}
+
+bool asm_line::operands(const code_macro* macro, const char* operand, \
+                        const op_arg* args, size_t num_args, \
+                        const symbol_table& table, size_t pc, \
+                        gena_operands& ops) {
+    if (macro == NULL) {
+        return false;
+    }
+    ops.abi_version = GENA_ENCODER_ABI_VERSION;
+    ops.count = num_args;
+    ops.op_code = macro->op_code();
+    for (size_t i = 0; i < num_args; i++) {
+        const op_arg& arg = args[i];
+        gena_operand& op = ops.operands[i];
+        std::string_view text(operand + arg.pos, arg.len);
+        op.text = text.data();
+        op.text_len = text.size();
+        if (arg.pc) {
+            op.kind = GENA_OPERAND_PC;
+            op.value = pc;
         }
-        else if (table.find(symbol) != table.end()) {
-        args.insert(args.begin(), std::to_string(table.find(symbol)->second));
+        else if (const symbol_entry* entry = table.find(arg.symbol)) {
+            op.kind = GENA_OPERAND_SYMBOL;
+            op.value = entry->value;
         }
         else {
-            args.insert(args.begin(), symbol);
+            parse_operand(text, op);
         }
     }
-    result = std::string::npos;
-    try {
-        code_macro::func_ptr function = macro.func();
-        result = function(macro.op_code(), args);
+    return true;
+}
+
+// Helper functions.
+void asm_line::parse_operand(std::string_view text, gena_operand& op) {
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    const char* digits = begin;
+    op.kind = GENA_OPERAND_NAME;
+    op.value = 0;
+    // Decimal numbers are integers, and letters followed by a decimal number
+    // are registers.
+    while ((digits != end) && std::isalpha(static_cast<unsigned char>( \
+                                           *digits))) {
+        digits++;
+    }
+    if ((digits == end) || ((digits != begin) && !std::isdigit( \
+                             static_cast<unsigned char>(*digits)))) {
+        return;
     }
-    catch (const std::exception& e) {
-        return result;
+    int64_t value;
+    auto parsed = std::from_chars(digits, end, value);
+    if ((parsed.ec == std::errc()) && (parsed.ptr == end)) {
+        op.kind = (digits == begin) ? GENA_OPERAND_INTEGER : \
+                                      GENA_OPERAND_REGISTER;
+        op.value = value;
     }
-    return result;
 }
 
-
 // Assessors.
-std::string asm_line::origin_file(void) {
+std::string_view asm_line::origin_file(void) const {
     return origin_file_path_;
 }
-std::string asm_line::text(void) {
+std::string_view asm_line::text(void) const {
     return text_;
 }
-std::string asm_line::label(void) {
+std::string_view asm_line::label(void) const {
     return label_;
+}
+uint32_t asm_line::label_symbol(void) const {
+    return label_symbol_;
+}
+std::string_view asm_line::op_name(void) const {
+    return op_name_;
+}
+std::string_view asm_line::operand(void) const {
+    return operand_;
+}
+const code_macro* asm_line::macro(void) const {
+    return macro_;
+}
+const op_arg* asm_line::arguments(void) const {
+    return arguments_;
+}
+size_t asm_line::num_arguments(void) const {
+    return num_arguments_;
 }
\ No newline at end of file
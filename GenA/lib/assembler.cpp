@@ -13,16 +13,28 @@
 #include "assembler.hpp"
 #include "asm_line.hpp"
 #include "isa.hpp"
+#include "segment_image.hpp"
+#include "source_cache.hpp"
+#include "chunk_runner.hpp"
+#include "image_writer.hpp"
+#include "listing_writer.hpp"
+#include "gena_abi.h"
+#include "diagnostics.hpp"
 #include <stdlib.h>
 #include <string>
-#include <list>
+#include <string_view>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <utility>
 #include <algorithm>
 #include <iomanip>
 #include <unordered_set>
+#include <unordered_map>
+#include <vector>
 #include <cmath>
+#include <chrono>
+#include <sys/resource.h>
 
 // Constants.
 const std::string PSEUDO_OP = ".";
@@ -38,26 +50,58 @@ const size_t INCLUDE_SIZE = 2;
 const size_t LABEL_DISPLAY_SIZE = 25;
 const std::string LISTING_FILE_NAME = "list_gena.lst";
 const std::string LINE_NUM = " line  number: ";
+// The most instructions given to a batch encoder at once.
+const size_t ENCODE_BATCH_SIZE = 256;
+// The number of lines each thread encodes at a time.
+const size_t ENCODE_CHUNK_SIZE = 4096;
 
 // Constructor.
 assembler::assembler(std::string entry_path, std::string isa_file_path, \
-                     std::string output_file_path, bool verbose, \
-                     bool list) : entry_path_(entry_path), \
-                     cpu_isa_(isa_file_path), \
-                     output_file_path_(output_file_path), \
-                     verbose_(verbose), list_(list), pc_(0), data_used_(0) {}
+                     std::string output_file_path, output_format format, \
+                     bool verbose, bool list, bool relax, \
+                     std::string cache_dir, bool rebuild, size_t jobs, \
+                     std::string build_db_path) : \
+                     entry_path_(entry_path), \
+                     own_lib_cache_(std::make_unique<lib_cache>(cache_dir, \
+                                                                rebuild)), \
+                     own_isa_(std::make_unique<isa>(isa_file_path, \
+                                                    *own_lib_cache_)), \
+                     own_sources_(std::make_unique<source_cache>(*own_isa_)), \
+                     cpu_isa_(*own_isa_), sources_(*own_sources_), \
+                     output_file_path_(output_file_path), format_(format), \
+                     verbose_(verbose), list_(list), relax_(relax), \
+                     runner_(jobs), pc_(0), data_used_(0), stats_() {
+    start_stats();
+    // The ISA was loaded for this assembly.
+    stats_.isa_parse = cpu_isa_.load_times().parse;
+    stats_.lib_compile = cpu_isa_.load_times().compile;
+    stats_.lib_load = cpu_isa_.load_times().load;
+    open_build_db(build_db_path);
+}
+
+assembler::assembler(std::string entry_path, isa& cpu_isa, \
+                     source_cache& sources, std::string output_file_path, \
+                     output_format format, bool verbose, bool list, \
+                     bool relax, size_t jobs, std::string build_db_path) : \
+                     entry_path_(entry_path), cpu_isa_(cpu_isa), \
+                     sources_(sources), output_file_path_(output_file_path), \
+                     format_(format), verbose_(verbose), list_(list), \
+                     relax_(relax), runner_(jobs), pc_(0), data_used_(0), \
+                     stats_() {
+    start_stats();
+    open_build_db(build_db_path);
+}
 
 // Destructor
 assembler::~assembler() {};
 
 // Public functions.
 bool assembler::first_pass(void) {
-    std::vector<std::pair<std::pair<std::string, size_t>, std::ifstream>> \
-    asm_file_stack;
-    std::ifstream entry_file;
-    std::string line;
-    size_t line_num = 0;;
-    std::string temp_line;
+    auto start = std::chrono::steady_clock::now();
+    diagnostics& diag = diagnostics::global();
+    std::vector<source_frame> asm_file_stack;
+    const std::vector<parsed_line>* entry_lines;
+    size_t line_num = 0;
     bool next_file;
     std::string file_path;
     size_t inst_size;
@@ -67,148 +111,200 @@ bool assembler::first_pass(void) {
     valid_extension_ = entry_path_.substr(entry_path_.find_last_of('.'));
 
     // Push the entry file onto the file stack.
-    entry_file.open(entry_path_);
+    entry_lines = sources_.load(entry_path_, runner_, db_.get());
     // Display error message and exit if file can not be opened.
-    if (!entry_file) {
-        std::cerr << "Error: Cannot open entry file: " << entry_path_ << \
-        std::endl;
+    if (entry_lines == NULL) {
+        diag.report({DIAG_ERROR, "entry-open", "", 0, 0}, \
+                    [&](std::ostream& out) {
+            out << "Cannot open entry file: " << entry_path_;
+        });
         exit(EXIT_FAILURE);
     }
-    asm_file_stack.push_back({{entry_path_, line_num}, std::move(entry_file)});
+    asm_file_stack.push_back({entry_path_, entry_lines, 0, 0});
+    program_files_.push_back(entry_path_);
 
     // While there are still files to assemble, get the file name and file from
     // the top of the stack.
     while (!asm_file_stack.empty()) {
-        std::pair<std::pair<std::string, size_t>, std::ifstream>& \
-        asm_file_pair = asm_file_stack.back();
-        std::ifstream& asm_file = asm_file_pair.second;
+        // Frames are accessed by index since including a file grows the stack.
+        size_t top = asm_file_stack.size() - 1;
+        // Files are parsed when they are loaded, the symbols and program
+        // counter are updated from their lines in order.
+        const std::vector<parsed_line>& lines = *asm_file_stack.at(top).lines;
 
         next_file = false;
-        // This is the line number stored with the file path
-        line_num = asm_file_pair.first.second;
-        file_path = asm_file_pair.first.first;
-
-        while (std::getline(asm_file, line) && !next_file) {
-            // Update the line number as it comes in and out of the stack.
-            line_num++;
-            asm_file_pair.first.second = line_num;
-            // If while parsing, the continue symbol is at the end of the line,
-            // save the line in a temp for when the next cycle comes.
-            if (line.find(CONTINUE) == (line.size() - 1)) {
-                temp_line += line.substr(0, line.size() - 2);
+        file_path = asm_file_stack.at(top).path;
+
+        while (!next_file && (asm_file_stack.at(top).line < lines.size())) {
+            const parsed_line& entry = lines.at(asm_file_stack.at(top).line);
+            asm_file_stack.at(top).line++;
+            line_num = entry.line_num;
+            if (!entry.diagnostic.empty()) {
+                diag.report({DIAG_ERROR, "no-macro", file_path, line_num, 0}, \
+                            [&](std::ostream& out) {
+                    out << entry.diagnostic;
+                });
+            }
+            stats_.lines++;
+
+            // If the line is a pseudo operation, pass it to the handler, 
+            // which can modify the file and line search.
+            if (entry.pseudo) {
+                success = pseudo_op_handler(std::string(entry.work, \
+                                                        entry.len), \
+                                            line_num, next_file, \
+                                            asm_file_stack) && success;
             }
             else {
-                // No line continuations so line is updated and temp line is 
-                // reset.
-                line = temp_line + line;
-                temp_line = "";
-                // If the line is a pseudo operation, pass it to the handler, 
-                // which can modify the file and line search.
-                if ((line.find(PSEUDO_OP) == 0)) {
-                    success = pseudo_op_handler(line, next_file, \
-                                                asm_file_stack);
-                }
-                else {
-                    // Make sure assembly line is valid before adding it to the 
-                    // assembly program data member.
-                    asm_line assembly_line = cpu_isa_.parse_asm(line, \
-                    file_path);  
-                    if (assembly_line.origin_file() != ASM_INVALID) {
-                        if (assembly_line.label() != "") {
-                            // Update the symbol table if there is a label and
-                            // it is not the same name as any var or const.
-                            if (symbol_table_.count(assembly_line.label()) == \
-                                0) {
-                                symbol_table_.insert({assembly_line.label(), \
-                                                      pc_});
-                            }
-                            else  {
-                                std::cerr << "Error: Redefinition of " << \
-                                assembly_line.label() << " on line " << \
-                                line_num << " in file " << file_path \
-                                << std::endl;
-                                success = false;
-                            }
-                        }
-                        // If there is an instruction then put it at pc which
-                        // maybe changed by code location.
-                        inst_size = assembly_line.size(cpu_isa_);
-                        if (inst_size > 0) {
-                            auto it = asm_prog_.begin();
-                            for (size_t i = 0; i < pc_; ++i) {
-                                if (it != asm_prog_.end()) {
-                                    ++it;
-                                } else {
-                                    asm_prog_.push_back(asm_line(ASM_INVALID, \
-                                    ASM_INVALID, ASM_INVALID, ASM_INVALID, \
-                                    ASM_INVALID));
-                                    it = asm_prog_.end();
-                                }
-                            }
-                            asm_prog_.insert(it, assembly_line);
-                            pc_ += inst_size;
+                // Make sure assembly line is valid before adding it to the 
+                // assembly program data member.
+                const asm_line& assembly_line = entry.line;
+                if (assembly_line.origin_file() != ASM_INVALID) {
+                    if (assembly_line.macro() != NULL) {
+                        stats_.macros_matched++;
+                    }
+                    if (!assembly_line.label().empty()) {
+                        // Update the symbol table if there is a label and
+                        // it is not the same name as any var or const.
+                        stats_.symbol_lookups++;
+                        if (define_symbol(assembly_line.label_symbol(), pc_, \
+                                          SYMBOL_LABEL, \
+                                          asm_file_stack.at(top), line_num)) {
+                            label_lines_.push_back({ \
+                                assembly_line.label_symbol(), \
+                                prog_image_.size()});
                         }
                         else {
-                            // Still keep the line;
-                            asm_prog_.push_back(assembly_line);
+                            success = false;
                         }
                     }
-                    // The line of assembly itself is invalid and thus the
-                    // process is unsuccessful.
-                    else {
-                        std::cerr << "Error: Invalid line of assembly on " << \
-                        "line " << line_num << " in file " << \
-                        file_path << std::endl;
+                    // Place the line at pc which maybe changed by code
+                    // location. Lines without an instruction are still
+                    // kept at pc for the listing.
+                    inst_size = assembly_line.size();
+                    if (!prog_image_.place(pc_, assembly_line, inst_size)) {
+                        diag.report({DIAG_ERROR, "overlap", file_path, \
+                                     line_num, 0}, [](std::ostream& out) {
+                            out << "Code overlaps previously placed code";
+                        });
                         success = false;
                     }
+                    pc_ += inst_size;
+                }
+                // The line of assembly itself is invalid and thus the
+                // process is unsuccessful.
+                else {
+                    diag.report({DIAG_ERROR, "invalid-line", file_path, \
+                                 line_num, 0}, [](std::ostream& out) {
+                        out << "Invalid line of assembly";
+                    });
+                    success = false;
                 }
             }
             // If the program exceeds the memory a warning is reported but the 
             // process first pass remains successful for assembly.
             if (pc_ > cpu_isa_.word_sizes().front() * \
                       cpu_isa_.mem_sizes().front()) {
-                std::clog << "Warning: " << \
-                std::to_string(cpu_isa_.mem_sizes().front()) << " words of " \
-                << "the program memory exceeded on line " << line_num \
-                << " in file " << file_path << std::endl;
+                diag.report({DIAG_WARNING, "program-memory", file_path, \
+                             line_num, 0}, [&](std::ostream& out) {
+                    out << cpu_isa_.mem_sizes().front() << " words of the " \
+                        << "program memory exceeded";
+                });
                 success = false;
             }
             if (cpu_isa_.harv_not_princ()) {
                 if (data_used_ > cpu_isa_.word_sizes().back() * \
                         cpu_isa_.mem_sizes().back()) {
-                    std::clog << "Warning: " << \
-                    std::to_string(cpu_isa_.mem_sizes().back()) << " words " \
-                    << "of the data memory exceeded on line " << line_num \
-                    << " in file " << file_path << std::endl;
+                    diag.report({DIAG_WARNING, "data-memory", file_path, \
+                                 line_num, 0}, [&](std::ostream& out) {
+                        out << cpu_isa_.mem_sizes().back() << " words of " \
+                            << "the data memory exceeded";
+                    });
                     success = false;
                 }
             }
         }
-        // If the end of the file is reached, close the file and pop it off the
-        // stack.
+        // If the end of the file is reached, pop it off the stack.
         if (!next_file) {
-            asm_file.close();
             asm_file_stack.pop_back();
         }        
-        // If next file is set true, the next file on the stack is opened.
-    }    
-    std::clog << "\nFirst pass complete. \n\nSymbol table:" \
-              << std::endl;
-    // Iterate through the symbol table and print each key-value pair.
-    std::string disp_label;
-    for (auto pair : symbol_table_) {
-        disp_label = pair.first.substr(0, std::min(pair.first.size(), \
-                     LABEL_DISPLAY_SIZE));
-        std::clog << disp_label << \
-        std::string(LABEL_DISPLAY_SIZE - disp_label.size(), ' ') << " | 0x" << \
-        std::hex << pair.second << std::endl;
+        // If next file is set true, the next file on the stack is read.
+    }
+    if (relax_) {
+        stats_.relaxed = relax();
+        diag.report({DIAG_INFO, "relax-summary", "", 0, 0}, \
+                    [&](std::ostream& out) {
+            out << stats_.relaxed << " instructions relaxed to a shorter " \
+                << "form.";
+        });
     }
+    if (db_ != NULL) {
+        diag.report({DIAG_INFO, "db-restored", "", 0, 0}, \
+                    [&](std::ostream& out) {
+            out << sources_.num_restored() << " of " << program_files_.size() \
+                << " files restored from the build database.";
+        });
+    }
+    // Display each key-value pair of the symbol table, only formatted if it
+    // is written.
+    diag.report({DIAG_INFO, "symbol-table", "", 0, 0}, \
+                [&](std::ostream& out) {
+        std::string_view disp_label;
+        out << "\nFirst pass complete. \n\nSymbol table:";
+        for (uint32_t id : symbol_table_.defined()) {
+            disp_label = sources_.symbols().name(id).substr(0, \
+                                                         LABEL_DISPLAY_SIZE);
+            out << "\n" << disp_label << \
+            std::string(LABEL_DISPLAY_SIZE - disp_label.size(), ' ') << \
+            " | 0x" << std::hex << symbol_table_.find(id)->value << std::dec;
+        }
+    });
+    stats_.files = program_files_.size();
+    stats_.first_pass = seconds_since(start);
     return success;
 }
 
 bool assembler::second_pass(void) {
-    std::ofstream output_file(output_file_path_);
-    std::ofstream list_file;
+    bool success = encode_pass();
+    success = write_output() && success;
+    return write_listing() && success;
+}
+
+bool assembler::encode_pass(void) {
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<uint32_t>& sizes = prog_image_.sizes();
+    bool success = true;
+
+    prog_image_.order_by_address();
+    encode_program(encoded_, encoded_ok_, keys_, stats_.symbol_lookups);
+    // Error for every instruction the assembly was unsuccessful for.
+    for (size_t i = 0; i < sizes.size(); i++) {
+        if (sizes[i] == 0) {
+            continue;
+        }
+        stats_.instructions++;
+        if (!encoded_ok_.at(i)) {
+            diagnostics::global().report({DIAG_ERROR, "encode-failed", "", \
+                                          0, 0}, [&](std::ostream& out) {
+                out << "ISA User library function failed for assembly " \
+                    << "line: " << prog_image_.lines().at(i)->text();
+            });
+            success = false;
+        }
+    }
+    stats_.second_pass = seconds_since(start);
+    return success;
+}
+
+bool assembler::write_output(void) {
+    auto start = std::chrono::steady_clock::now();
+    std::ofstream output_file(output_file_path_, std::ios::binary);
+    // Only the program segment has contents. In harvard ISAs the data memory
+    // holds variables that are reserved but never initialized.
+    image_writer prog_writer(format_, cpu_isa_.word_sizes().front(), \
+                             cpu_isa_.little_endian(), \
+                             cpu_isa_.endian_unit_bits());
+    bool success = true;
 
     // Open the output file. If it can not be opened display to the user that
     // a listing file will be used instead even if they do not have the verbose 
@@ -218,63 +314,383 @@ bool assembler::second_pass(void) {
         << ". Will produce listing file " << LISTING_FILE_NAME << std::endl;
         list_ = true;
     }
-    if (list_) {
-        list_file.open(LISTING_FILE_NAME);
-        list_file.clear();
-
-        size_t addr = 0;
-        std::string value;
-        size_t width = 5;
-        size_t data;
-        for (asm_line line : asm_prog_) {
-            addr++;
-            if (line.origin_file() != ASM_INVALID) {
-                if (list_file) {
-                    if (line.size(cpu_isa_) > 0) {
-                        data = line.assemble(cpu_isa_, symbol_table_, addr);
-                        if (data != std::string::npos) {
-                            list_file << std::setw(width) << std::setfill('0') \
-                                << std::hex << addr << " " 
-                                << std::setw(width) << std::setfill('0')
-                                << std::hex 
-                                << line.assemble(cpu_isa_, symbol_table_, addr) 
-                                << "\t;" 
-                                << line.text() \
-                                << std::endl;
-                            addr += line.size(cpu_isa_);
-                        }
-                        // Error if the assembly was unsuccessful.
-                        else {
-                            std::cerr << "Error: ISA User library function " << 
-                            "failed for assembly line: " << line.text() 
-                            << std::endl;
-                        }
-                    } 
-                    else {
-                        list_file << "\t\t\t\t;" << line.text() \
-                        << std::endl;
-                    }
-                }
-            }
+
+    const std::vector<size_t>& addresses = prog_image_.addresses();
+    const std::vector<uint32_t>& sizes = prog_image_.sizes();
+    const size_t word_size = cpu_isa_.word_sizes().front();
+    // Walk the program image in address order.
+    for (size_t i = 0; i < sizes.size(); i++) {
+        if ((sizes[i] > 0) && encoded_ok_[i]) {
+            prog_writer.add(addresses[i] / word_size, encoded_[i], sizes[i]);
         }
     }
     if (output_file) {
+        if (!prog_writer.write(output_file)) {
+            diagnostics::global().report({DIAG_ERROR, "output-write", "", 0, \
+                                          0}, [&](std::ostream& out) {
+                out << "Cannot write output file " << output_file_path_;
+            });
+            success = false;
+        }
+        else {
+            stats_.bytes_emitted = output_file.tellp();
+        }
         output_file.close();
     }
-    if (list_file) {
-        list_file.close();
+    if ((db_ != NULL) && !update_build_db(keys_, encoded_, encoded_ok_)) {
+        diagnostics::global().report({DIAG_ERROR, "db-write", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Cannot write build database " << db_->path();
+        });
     }
-    return true;
+    stats_.output = seconds_since(start);
+    return success;
+}
+
+bool assembler::write_listing(void) {
+    if (!list_) {
+        return true;
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::ofstream list_file(LISTING_FILE_NAME, std::ios::binary);
+    listing_writer listing(list_file);
+    const std::vector<size_t>& addresses = prog_image_.addresses();
+    const std::vector<uint32_t>& sizes = prog_image_.sizes();
+    const std::vector<const asm_line*>& lines = prog_image_.lines();
+    const size_t word_size = cpu_isa_.word_sizes().front();
+    bool success;
+
+    // List the program image in address order from the instructions already
+    // encoded. Instructions that could not be encoded are left out.
+    for (size_t i = 0; i < sizes.size(); i++) {
+        if (sizes[i] == 0) {
+            listing.add_text(lines[i]->text());
+        }
+        else if (encoded_ok_[i]) {
+            listing.add_code(addresses[i] / word_size, encoded_[i], \
+                             lines[i]->text());
+        }
+    }
+    success = listing.finish();
+    if (!success) {
+        diagnostics::global().report({DIAG_ERROR, "listing-write", "", 0, \
+                                      0}, [&](std::ostream& out) {
+            out << "Cannot write listing file " << LISTING_FILE_NAME;
+        });
+    }
+    stats_.listing = seconds_since(start);
+    return success;
+}
+
+// Accessors
+const source_cache& assembler::sources(void) const {
+    return sources_;
+}
+const std::vector<std::string>& assembler::program_files(void) const {
+    return program_files_;
+}
+assembly_stats assembler::stats(void) const {
+    assembly_stats current = stats_;
+    struct rusage usage;
+
+    current.match_attempts = cpu_isa_.match_attempts() - \
+                             stats_.match_attempts;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        current.peak_rss_kb = usage.ru_maxrss;
+    }
+    return current;
 }
 
 // Helper functions.
 
-bool assembler::pseudo_op_handler(std::string line, bool& next_file, \
-        std::vector<std::pair<std::pair<std::string, size_t>, std::ifstream>>& \
-                       asm_file_stack) {
+size_t assembler::relax(void) {
+    // A line that can be relaxed, with the line of its target, its forms and
+    // the form it has, the form after the last being its own code macro.
+    struct span {
+        size_t line;
+        size_t target;
+        const code_macro* written;
+        const std::vector<relax_form>* forms;
+        size_t form;
+    };
+    std::vector<span> spans;
+    std::unordered_map<uint32_t, size_t> label_line;
+    const std::vector<size_t>& addresses = prog_image_.addresses();
+    const int64_t word_size = cpu_isa_.word_sizes().front();
+    size_t relaxed = 0;
+
+    for (const auto& [id, line] : label_lines_) {
+        label_line.insert({id, line});
+    }
+    // Every line that can be relaxed and has a label to reach starts at its
+    // smallest form.
+    for (size_t i = 0; i < prog_image_.size(); i++) {
+        const code_macro* macro = prog_image_.macros()[i];
+        if (macro == NULL) {
+            continue;
+        }
+        const std::vector<relax_form>& forms = cpu_isa_.relax_forms(macro);
+        if (forms.empty()) {
+            continue;
+        }
+        const op_arg* args = prog_image_.arguments()[i];
+        for (size_t j = 0; j < prog_image_.num_arguments()[i]; j++) {
+            auto target = args[j].pc ? label_line.end() : \
+                                       label_line.find(args[j].symbol);
+            if (target != label_line.end()) {
+                spans.push_back({i, target->second, macro, &forms, 0});
+                prog_image_.resize(i, forms.front().macro, \
+                                   forms.front().macro->num_inst_bits());
+                break;
+            }
+        }
+    }
+    prog_image_.reflow();
+
+    // Growing a line can only push targets out of range of other lines, so
+    // lines grow until none is out of range.
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        for (span& s : spans) {
+            if (s.form == s.forms->size()) {
+                continue;
+            }
+            const relax_form& form = s.forms->at(s.form);
+            int64_t distance = static_cast<int64_t>(addresses[s.target]) - \
+                               static_cast<int64_t>(addresses[s.line]);
+            if ((distance >= form.min * word_size) && \
+                (distance <= form.max * word_size)) {
+                continue;
+            }
+            s.form++;
+            const code_macro* macro = (s.form == s.forms->size()) ? \
+                                      s.written : s.forms->at(s.form).macro;
+            prog_image_.resize(s.line, macro, macro->num_inst_bits());
+            grown = true;
+        }
+        prog_image_.reflow();
+    }
+
+    for (const span& s : spans) {
+        relaxed += (s.form < s.forms->size());
+    }
+    // Labels are at the address of their line.
+    for (const auto& [id, line] : label_lines_) {
+        symbol_table_.set_value(id, addresses[line]);
+    }
+    return relaxed;
+}
+
+void assembler::start_stats(void) {
+    stats_.entry_path = entry_path_;
+    stats_.jobs = runner_.jobs();
+    // Only templates tried after this are counted.
+    stats_.match_attempts = cpu_isa_.match_attempts();
+}
+
+double assembler::seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - \
+                                         start).count();
+}
+
+void assembler::encode_program(std::vector<uint64_t>& encoded, \
+                               std::vector<uint8_t>& encoded_ok, \
+                               std::vector<std::string>& keys, \
+                               uint64_t& num_lookups) const {
+    size_t num_lines = prog_image_.size();
+    std::atomic<size_t> num_reused(0);
+    std::atomic<uint64_t> lookups(0);
+
+    encoded.assign(num_lines, 0);
+    encoded_ok.assign(num_lines, false);
+    keys.assign((db_ != NULL) ? num_lines : 0, std::string());
+    // Chunks write to disjoint parts of the results.
+    runner_.run((num_lines + ENCODE_CHUNK_SIZE - 1) / ENCODE_CHUNK_SIZE, \
+                [&](size_t chunk) {
+        size_t begin = chunk * ENCODE_CHUNK_SIZE;
+        encode_range(begin, std::min(begin + ENCODE_CHUNK_SIZE, num_lines), \
+                     encoded, encoded_ok, keys, num_reused, lookups);
+    });
+    num_lookups += lookups;
+    if (db_ != NULL) {
+        diagnostics::global().report({DIAG_INFO, "db-reused", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << num_reused << " instructions reused from the build " \
+                << "database.";
+        });
+    }
+}
+
+void assembler::encode_range(size_t begin, size_t end, \
+                             std::vector<uint64_t>& encoded, \
+                             std::vector<uint8_t>& encoded_ok, \
+                             std::vector<std::string>& keys, \
+                             std::atomic<size_t>& num_reused, \
+                             std::atomic<uint64_t>& num_lookups) const {
+    // The pending instructions of a batch encoder and where their results go.
+    struct batch {
+        gena_encode_batch_fn encoder;
+        std::vector<gena_operands> ops;
+        std::vector<size_t> slots;
+    };
+    std::vector<batch> batches;
+    std::unordered_map<gena_encode_batch_fn, size_t> batch_index;
+    // Only the hot columns of the image are read.
+    const std::vector<size_t>& addresses = prog_image_.addresses();
+    const std::vector<uint32_t>& sizes = prog_image_.sizes();
+    const std::vector<const code_macro*>& macros = prog_image_.macros();
+    const std::vector<const char*>& operands = prog_image_.operands();
+    const std::vector<const op_arg*>& arguments = prog_image_.arguments();
+    const std::vector<uint8_t>& num_arguments = prog_image_.num_arguments();
+    uint64_t results[ENCODE_BATCH_SIZE];
+    gena_operands ops;
+    uint64_t lookups = 0;
+
+    // This encodes the pending instructions of a batch. If the batch fails its
+    // instructions are encoded one at a time so that only the lines that can
+    // not be encoded fail.
+    auto flush = [&](batch& group) {
+        if (group.encoder(group.ops.data(), group.ops.size(), results) == \
+            GENA_ENCODE_OK) {
+            for (size_t j = 0; j < group.slots.size(); j++) {
+                encoded.at(group.slots.at(j)) = results[j];
+                encoded_ok.at(group.slots.at(j)) = true;
+            }
+        }
+        else {
+            for (size_t j = 0; j < group.slots.size(); j++) {
+                size_t slot = group.slots.at(j);
+                uint64_t result;
+                if (macros[slot]->encode(group.ops.at(j), result)) {
+                    encoded.at(slot) = result;
+                    encoded_ok.at(slot) = true;
+                }
+            }
+        }
+        group.ops.clear();
+        group.slots.clear();
+    };
+
+    // Lines whose function has a batch encoder are grouped by it and encoded
+    // a batch at a time, all others are encoded one at a time.
+    for (size_t i = begin; i < end; i++) {
+        const code_macro* macro = macros[i];
+        if ((sizes[i] == 0) || \
+            !asm_line::operands(macro, operands[i], arguments[i], \
+                                num_arguments[i], symbol_table_, \
+                                addresses[i], ops)) {
+            continue;
+        }
+        // Every operand but the program counter is looked up.
+        for (uint32_t j = 0; j < ops.count; j++) {
+            lookups += (ops.operands[j].kind != GENA_OPERAND_PC);
+        }
+        // Instructions are only encoded again if their operands changed.
+        if (db_ != NULL) {
+            uint64_t result;
+            keys.at(i) = operands_key(macro, ops);
+            if (db_->result(keys.at(i), result)) {
+                encoded.at(i) = result;
+                encoded_ok.at(i) = true;
+                num_reused++;
+                continue;
+            }
+        }
+        if (macro->batch_encoder() == NULL) {
+            uint64_t result;
+            if (macro->encode(ops, result)) {
+                encoded.at(i) = result;
+                encoded_ok.at(i) = true;
+            }
+            continue;
+        }
+        auto entry = batch_index.find(macro->batch_encoder());
+        if (entry == batch_index.end()) {
+            entry = batch_index.insert({macro->batch_encoder(), \
+                                        batches.size()}).first;
+            batches.push_back({macro->batch_encoder(), {}, {}});
+            batches.back().ops.reserve(ENCODE_BATCH_SIZE);
+            batches.back().slots.reserve(ENCODE_BATCH_SIZE);
+        }
+        batch& group = batches.at(entry->second);
+        group.ops.push_back(ops);
+        group.slots.push_back(i);
+        if (group.ops.size() == ENCODE_BATCH_SIZE) {
+            flush(group);
+        }
+    }
+    for (batch& group : batches) {
+        if (!group.ops.empty()) {
+            flush(group);
+        }
+    }
+    num_lookups += lookups;
+}
+
+std::string assembler::operands_key(const code_macro* macro, \
+                                    const gena_operands& ops) const {
+    std::string key;
+    // This appends the bytes of a value.
+    auto put = [&key](uint64_t value) {
+        key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    put(cpu_isa_.macro_index(macro));
+    put(ops.count);
+    for (uint32_t i = 0; i < ops.count; i++) {
+        const gena_operand& op = ops.operands[i];
+        put(op.kind);
+        put(op.value);
+        put(op.text_len);
+        key.append(op.text, op.text_len);
+    }
+    return key;
+}
+
+bool assembler::update_build_db(const std::vector<std::string>& keys, \
+                                const std::vector<uint64_t>& encoded, \
+                                const std::vector<uint8_t>& encoded_ok) {
+    std::unordered_map<std::string, uint64_t> results;
+    bool changed;
+
+    // The database holds the files and instructions of the latest build. It
+    // is only written again if they changed.
+    changed = sources_.record(program_files_, *db_);
+    for (size_t i = 0; i < keys.size(); i++) {
+        uint64_t recorded;
+        if (!keys.at(i).empty() && encoded_ok.at(i)) {
+            results[keys.at(i)] = encoded.at(i);
+            changed = changed || !db_->result(keys.at(i), recorded);
+        }
+    }
+    if (!changed && (results.size() == db_->num_results())) {
+        return true;
+    }
+    db_->set_results(std::move(results));
+    return db_->save();
+}
+
+void assembler::open_build_db(const std::string& path) {
+    if (path.empty()) {
+        return;
+    }
+    db_ = std::make_unique<build_db>(path, cpu_isa_.fingerprint());
+    if (!db_->load()) {
+        diagnostics::global().report({DIAG_INFO, "db-unused", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Build database " << path << " not used, it will be " \
+                << "written after the second pass.";
+        });
+    }
+}
+
+bool assembler::pseudo_op_handler(const std::string& line, size_t line_num, \
+                                  bool& next_file, \
+                                  std::vector<source_frame>& asm_file_stack) {
     std::vector<std::string> line_data;
-    std::string file_path = asm_file_stack.back().first.first;
-    size_t line_num = asm_file_stack.back().first.second;
+    const std::string file_path = asm_file_stack.back().path;
+    diagnostics& diag = diagnostics::global();
     line_data = cpu_isa_.split_by_spaces(line.substr(PSEUDO_OP.length()));
     // Conditionals for pseudo operations as they are all very different.
     // The number after the code location pseudo op gets set to the pc. 
@@ -285,9 +701,11 @@ bool assembler::pseudo_op_handler(std::string line, bool& next_file, \
             }
             // Display error message if string is not a positive integer.
             catch (const std::exception& e) {
-                std::cerr << "Error: Invalid code location entry: " << \
-                line_data.at(CODE_LOC_SIZE) << " on line " << line_num << \
-                " in file: " << file_path << std::endl;
+                diag.report({DIAG_ERROR, "code-location", file_path, \
+                             line_num, 0}, [&](std::ostream& out) {
+                    out << "Invalid code location entry: " << \
+                    line_data.at(CODE_LOC_SIZE - 1);
+                });
                 return false;
             }
             pc_ = std::stoul(line_data.at(CODE_LOC_SIZE - 1)) * \
@@ -309,9 +727,11 @@ bool assembler::pseudo_op_handler(std::string line, bool& next_file, \
             }
             // Display error message if string is not a positive integer.
             catch (const std::exception& e) {
-                std::cerr << "Error: Invalid variable word count entry " << \
-                line_data.at(VAR_DEC_SIZE) << " on line " << line_num << \
-                " in file: " << file_path << std::endl;
+                diag.report({DIAG_ERROR, "data-count", file_path, \
+                             line_num, 0}, [&](std::ostream& out) {
+                    out << "Invalid variable word count entry " << \
+                    line_data.at(VAR_DEC_SIZE - 1);
+                });
                 return false;
             }
             if (cpu_isa_.harv_not_princ()) {
@@ -320,16 +740,8 @@ bool assembler::pseudo_op_handler(std::string line, bool& next_file, \
             }
             // If the var name already exists as a variable or label display an
             // error.
-            if (symbol_table_.count(var_name) == \
-                0) {
-                symbol_table_.insert({var_name, \
-                                    *memory});
-            }
-            else  {
-                std::cerr << "Error: Redefinition of " << var_name << \
-                " on line " << line_num << " in file " << \
-                file_path << std::endl;
-            }           
+            define_symbol(sources_.symbols().intern(var_name), *memory, \
+                          SYMBOL_VARIABLE, asm_file_stack.back(), line_num);
             // The updated memory space pointer is updated.
             *memory = *memory + \
                       (bit_num * std::stoul(line_data.at(VAR_DEC_SIZE - 1)));
@@ -346,55 +758,66 @@ bool assembler::pseudo_op_handler(std::string line, bool& next_file, \
             }
             // Display error message if string is not a positive integer.
             catch (const std::exception& e) {
-                std::cerr << "Error: Invalid constant definition entry: " << \
-                line_data.at(CONST_SIZE) << " on line " << line_num << \
-                " in file: " << file_path << std::endl;
+                diag.report({DIAG_ERROR, "constant", file_path, \
+                             line_num, 0}, [&](std::ostream& out) {
+                    out << "Invalid constant definition entry: " << \
+                    line_data.at(CONST_SIZE - 1);
+                });
                 return false;
             }
             // If the const name already exists as a variable or label or const
             // display an error.
-            if (symbol_table_.count(const_name) == \
-                0) {
-                symbol_table_.insert({const_name, \
-                                   std::stoul(line_data.at(CONST_SIZE - 1))});
-            }
-            else  {
-                std::cerr << "Error: Redefinition of " << const_name << \
-                " on line " << line_num << " in file " << \
-                file_path << std::endl;
+            if (!define_symbol(sources_.symbols().intern(const_name), \
+                               std::stoul(line_data.at(CONST_SIZE - 1)), \
+                               SYMBOL_CONSTANT, asm_file_stack.back(), \
+                               line_num)) {
                 return false;
-            }           
+            }
         }
     }
     else if (cpu_isa_.strip_and_lower(line_data.at(0)) == INCLUDE) {
         if (line_data.size() == INCLUDE_SIZE) {
             std::string new_file_path = line_data.at(INCLUDE_SIZE - 1);
-            std::ifstream new_file(new_file_path);
+            const std::vector<parsed_line>* new_lines = NULL;
+            size_t extension = new_file_path.find_last_of('.');
             bool add_file = true;
-            // If an included file cannot be opened, has already been included,
-            // or does not have the right extension, display an error message 
-            // and don't add the file.
-            if (!new_file) {
-                std::cerr << "Error: Unable to open file: " << new_file_path \
-                          << ". File not included." << std::endl;
+            // If an included file has already been included, does not have
+            // the right extension, or cannot be opened, display an error
+            // message and don't add the file. It is only opened once it has
+            // passed the other checks.
+            if (asm_file_paths_.find(new_file_path) != asm_file_paths_.end()) {
+                diag.report({DIAG_ERROR, "include-repeat", file_path, \
+                             line_num, 0}, [&](std::ostream& out) {
+                    out << "File " << new_file_path << " already included, " \
+                        << "skipped";
+                });
                 add_file = false;
             }
-            if (asm_file_paths_.find(new_file_path) != asm_file_paths_.end()) {
-                std::cerr << "Error: File: " << new_file_path << " already " \
-                          << "included. File skipped." << std::endl;
+            if ((extension == std::string::npos) || \
+                (new_file_path.substr(extension) != valid_extension_)) {
+                diag.report({DIAG_ERROR, "include-extension", file_path, \
+                             line_num, 0}, [&](std::ostream& out) {
+                    out << "File " << new_file_path << " skipped, its " \
+                        << "extension is not " << valid_extension_;
+                });
                 add_file = false;
             }
-            if (new_file_path.substr(new_file_path.find_last_of('.')) !=
-                valid_extension_) {
-                std::cerr << "Error: File: " << new_file_path << " does not " \
-                          << "have valid extension: " << valid_extension_ << \
-                          ". File skipped." << std::endl;
+            if (add_file) {
+                new_lines = sources_.load(new_file_path, runner_, db_.get());
+            }
+            if (add_file && (new_lines == NULL)) {
+                diag.report({DIAG_ERROR, "include-open", file_path, \
+                             line_num, 0}, [&](std::ostream& out) {
+                    out << "Unable to open included file " << new_file_path;
+                });
                 add_file = false;
             }
             // Indicate that the next file on the stack should be moved to and 
             // add the included file.
             if (add_file) {
-                asm_file_stack.push_back(std::make_pair(std::make_pair(new_file_path, 0), std::move(new_file)));
+                asm_file_stack.push_back({new_file_path, new_lines, 0, \
+                                          program_files_.size()});
+                program_files_.push_back(new_file_path);
                 asm_file_paths_.insert(new_file_path);
                 next_file = true;
             }
@@ -402,3 +825,18 @@ bool assembler::pseudo_op_handler(std::string line, bool& next_file, \
     }
     return true;
 }
+
+bool assembler::define_symbol(uint32_t id, size_t value, symbol_kind kind, \
+                              const source_frame& frame, size_t line_num) {
+    if (symbol_table_.define(id, {value, kind, frame.file, line_num})) {
+        return true;
+    }
+    const symbol_entry* first = symbol_table_.find(id);
+    diagnostics::global().report({DIAG_ERROR, "redefinition", frame.path, \
+                                  line_num, 0}, [&](std::ostream& out) {
+        out << "Redefinition of " << sources_.symbols().name(id) \
+            << " (first defined on line " << first->line << " in file " \
+            << program_files_.at(first->file) << ")";
+    });
+    return false;
+}
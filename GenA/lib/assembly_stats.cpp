@@ -0,0 +1,87 @@
+// assembly_stats.cpp
+// C++ file for the assembly_stats struct implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "assembly_stats.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include <iomanip>
+#include <ios>
+#include <map>
+
+// Constants.
+// Times are written to the microsecond.
+const int STATS_TIME_PRECISION = 6;
+
+// Helper functions.
+// Writes a string as a JSON string, escaping quotes, backslashes and control
+// characters.
+static void write_json_string(std::ostream& out, const std::string& str) {
+    out << '"';
+    for (unsigned char c : str) {
+        if ((c == '"') || (c == '\\')) {
+            out << '\\' << c;
+        }
+        else if (c < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') \
+                << static_cast<unsigned>(c) << std::dec << std::setfill(' ');
+        }
+        else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+// Public functions.
+void assembly_stats::write_json(std::ostream& out) const {
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << std::dec << std::fixed << std::setprecision(STATS_TIME_PRECISION);
+    out << "{\n  \"version\": " << ASSEMBLY_STATS_VERSION << ",\n";
+    out << "  \"entry\": ";
+    write_json_string(out, entry_path);
+    out << ",\n  \"isa\": ";
+    write_json_string(out, isa_path);
+    out << ",\n  \"jobs\": " << jobs << ",\n" \
+        << "  \"success\": " << (success ? "true" : "false") << ",\n" \
+        << "  \"times\": {\n" \
+        << "    \"isa_parse\": " << isa_parse << ",\n" \
+        << "    \"lib_compile\": " << lib_compile << ",\n" \
+        << "    \"lib_load\": " << lib_load << ",\n" \
+        << "    \"first_pass\": " << first_pass << ",\n" \
+        << "    \"second_pass\": " << second_pass << ",\n" \
+        << "    \"output\": " << output << ",\n" \
+        << "    \"listing\": " << listing << ",\n" \
+        << "    \"total\": " << isa_parse + lib_compile + lib_load + \
+                                first_pass + second_pass + output + \
+                                listing << "\n" \
+        << "  },\n" \
+        << "  \"counters\": {\n" \
+        << "    \"files\": " << files << ",\n" \
+        << "    \"lines\": " << lines << ",\n" \
+        << "    \"macros_matched\": " << macros_matched << ",\n" \
+        << "    \"match_attempts\": " << match_attempts << ",\n" \
+        << "    \"symbol_lookups\": " << symbol_lookups << ",\n" \
+        << "    \"instructions\": " << instructions << ",\n" \
+        << "    \"relaxed\": " << relaxed << ",\n" \
+        << "    \"bytes_emitted\": " << bytes_emitted << "\n" \
+        << "  },\n" \
+        << "  \"peak_rss_kb\": " << peak_rss_kb << ",\n" \
+        << "  \"diagnostics\": {";
+    const char* separator = "\n";
+    for (const auto& [code, count] : diag_counts) {
+        out << separator << "    ";
+        write_json_string(out, code);
+        out << ": " << count;
+        separator = ",\n";
+    }
+    out << (diag_counts.empty() ? "}" : "\n  }") << "\n}" << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
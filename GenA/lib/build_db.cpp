@@ -0,0 +1,274 @@
+// build_db.cpp
+// C++ file for the build_db class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "build_db.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+// Constants.
+// Identifies database files and their format. Values are written in the byte
+// order of the machine, so a database from a machine with the other order has
+// the wrong version.
+const std::string BUILD_DB_MAGIC = "GENADB\n";
+const uint64_t BUILD_DB_VERSION = 2;
+const size_t BYTES_PER_U64 = 8;
+// The database is written to a temporary file first so a failed write does
+// not damage it.
+const std::string BUILD_DB_TEMP_SUFFIX = ".tmp";
+
+// Constructor.
+build_db::build_db(std::string path, uint64_t isa_fingerprint) : \
+                   path_(path), isa_fingerprint_(isa_fingerprint) {}
+
+// Destructor
+build_db::~build_db() {};
+
+// Public functions.
+bool build_db::load(void) {
+    std::ifstream db_file(path_, std::ios::binary);
+    std::ostringstream contents;
+
+    files_.clear();
+    results_.clear();
+    if (!db_file) {
+        return false;
+    }
+    contents << db_file.rdbuf();
+    if (!parse(contents.str())) {
+        files_.clear();
+        results_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool build_db::save(void) const {
+    std::string out = BUILD_DB_MAGIC;
+
+    put_u64(out, BUILD_DB_VERSION);
+    put_u64(out, isa_fingerprint_);
+    put_u64(out, files_.size());
+    for (const auto& entry : files_) {
+        const file_record& record = entry.second;
+        put_string(out, entry.first);
+        put_u64(out, record.hash);
+        put_string(out, record.work);
+        put_string(out, record.text);
+        put_u64(out, record.lines.size());
+        for (const line_record& line : record.lines) {
+            put_u64(out, line.line_num);
+            put_u64(out, line.pseudo);
+            for (const slice* part : {&line.work, &line.text, &line.label, \
+                                      &line.op_name, &line.operand}) {
+                put_u64(out, part->pos);
+                put_u64(out, part->len);
+            }
+            put_u64(out, line.macro);
+            put_u64(out, line.args.size());
+            for (const arg_record& arg : line.args) {
+                put_u64(out, arg.pos);
+                put_u64(out, arg.len);
+                put_u64(out, arg.pc);
+            }
+            put_string(out, line.diagnostic);
+        }
+    }
+    put_u64(out, results_.size());
+    for (const auto& entry : results_) {
+        put_string(out, entry.first);
+        put_u64(out, entry.second);
+    }
+
+    std::string temp_path = path_ + BUILD_DB_TEMP_SUFFIX;
+    std::ofstream db_file(temp_path, std::ios::binary | std::ios::trunc);
+    db_file.write(out.data(), out.size());
+    db_file.close();
+    if (!db_file || (std::rename(temp_path.c_str(), path_.c_str()) != 0)) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+const build_db::file_record* build_db::file(const std::string& path, \
+                                            uint64_t hash) const {
+    auto entry = files_.find(path);
+    if ((entry == files_.end()) || (entry->second.hash != hash)) {
+        return NULL;
+    }
+    return &entry->second;
+}
+
+void build_db::set_file(const std::string& path, file_record record) {
+    files_[path] = std::move(record);
+}
+
+bool build_db::keep_files(const std::unordered_set<std::string>& paths) {
+    bool forgot = false;
+    for (auto entry = files_.begin(); entry != files_.end();) {
+        if (paths.count(entry->first) == 0) {
+            entry = files_.erase(entry);
+            forgot = true;
+        }
+        else {
+            entry++;
+        }
+    }
+    return forgot;
+}
+
+bool build_db::result(const std::string& key, uint64_t& encoded) const {
+    auto entry = results_.find(key);
+    if (entry == results_.end()) {
+        return false;
+    }
+    encoded = entry->second;
+    return true;
+}
+
+void build_db::set_results(std::unordered_map<std::string, uint64_t> \
+                           results) {
+    results_ = std::move(results);
+}
+
+// Accessors
+const std::string& build_db::path(void) const {
+    return path_;
+}
+
+size_t build_db::num_results(void) const {
+    return results_.size();
+}
+
+// Helper functions.
+void build_db::put_u64(std::string& out, uint64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), BYTES_PER_U64);
+}
+
+void build_db::put_string(std::string& out, const std::string& str) {
+    put_u64(out, str.size());
+    out += str;
+}
+
+bool build_db::get_u64(const std::string& in, size_t& pos, uint64_t& value) {
+    if (in.size() - pos < BYTES_PER_U64) {
+        return false;
+    }
+    std::memcpy(&value, in.data() + pos, BYTES_PER_U64);
+    pos += BYTES_PER_U64;
+    return true;
+}
+
+bool build_db::get_string(const std::string& in, size_t& pos, \
+                          std::string& str) {
+    uint64_t len;
+    if (!get_u64(in, pos, len) || (in.size() - pos < len)) {
+        return false;
+    }
+    str = in.substr(pos, len);
+    pos += len;
+    return true;
+}
+
+bool build_db::parse(const std::string& in) {
+    size_t pos = BUILD_DB_MAGIC.size();
+    uint64_t version;
+    uint64_t fingerprint;
+    uint64_t num_files;
+    uint64_t num_results;
+
+    if ((in.compare(0, BUILD_DB_MAGIC.size(), BUILD_DB_MAGIC) != 0) || \
+        !get_u64(in, pos, version) || (version != BUILD_DB_VERSION) || \
+        !get_u64(in, pos, fingerprint) || \
+        (fingerprint != isa_fingerprint_) || !get_u64(in, pos, num_files)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < num_files; i++) {
+        std::string path;
+        file_record record;
+        uint64_t num_lines;
+        if (!get_string(in, pos, path) || !get_u64(in, pos, record.hash) || \
+            !get_string(in, pos, record.work) || \
+            !get_string(in, pos, record.text) || \
+            !get_u64(in, pos, num_lines)) {
+            return false;
+        }
+        // Every line takes more than a byte, so this bounds a damaged count.
+        record.lines.reserve(std::min<uint64_t>(num_lines, in.size() - pos));
+        for (uint64_t j = 0; j < num_lines; j++) {
+            line_record line;
+            uint64_t pseudo;
+            uint64_t num_args;
+            if (!get_u64(in, pos, line.line_num) || \
+                !get_u64(in, pos, pseudo)) {
+                return false;
+            }
+            line.pseudo = pseudo;
+            for (slice* part : {&line.work, &line.text, &line.label, \
+                                &line.op_name, &line.operand}) {
+                if (!get_u64(in, pos, part->pos) || \
+                    !get_u64(in, pos, part->len)) {
+                    return false;
+                }
+            }
+            // Slices must lie in their buffer.
+            const std::string& text = record.text;
+            const std::string& work = record.work;
+            if ((line.text.pos > text.size()) || \
+                (line.text.len > text.size() - line.text.pos)) {
+                return false;
+            }
+            for (const slice* part : {&line.work, &line.label, \
+                                      &line.op_name, &line.operand}) {
+                if ((part->pos > work.size()) || \
+                    (part->len > work.size() - part->pos)) {
+                    return false;
+                }
+            }
+            if (!get_u64(in, pos, line.macro) || \
+                !get_u64(in, pos, num_args)) {
+                return false;
+            }
+            for (uint64_t k = 0; k < num_args; k++) {
+                arg_record arg;
+                uint64_t pc;
+                if (!get_u64(in, pos, arg.pos) || \
+                    !get_u64(in, pos, arg.len) || !get_u64(in, pos, pc)) {
+                    return false;
+                }
+                arg.pc = pc;
+                line.args.push_back(arg);
+            }
+            if (!get_string(in, pos, line.diagnostic)) {
+                return false;
+            }
+            record.lines.push_back(std::move(line));
+        }
+        files_[path] = std::move(record);
+    }
+    if (!get_u64(in, pos, num_results)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < num_results; i++) {
+        std::string key;
+        uint64_t encoded;
+        if (!get_string(in, pos, key) || !get_u64(in, pos, encoded)) {
+            return false;
+        }
+        results_[key] = encoded;
+    }
+    return pos == in.size();
+}
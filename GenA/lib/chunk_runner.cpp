@@ -0,0 +1,47 @@
+// chunk_runner.cpp
+// C++ file for the chunk_runner class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "chunk_runner.hpp"
+#include <stdlib.h>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+// Constructor.
+chunk_runner::chunk_runner(size_t jobs) : jobs_(std::max<size_t>(1, jobs)) {}
+
+// Destructor
+chunk_runner::~chunk_runner() {};
+
+// Public functions.
+void chunk_runner::run(size_t num_chunks, \
+                       const std::function<void(size_t)>& work) const {
+    size_t num_threads = std::min(jobs_, num_chunks);
+    std::atomic<size_t> next_chunk(0);
+
+    // Every thread takes the next chunk until there are none left.
+    auto take = [&]() {
+        size_t chunk;
+        while ((chunk = next_chunk.fetch_add(1)) < num_chunks) {
+            work(chunk);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < num_threads; t++) {
+        threads.emplace_back(take);
+    }
+    take();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Accessors
+size_t chunk_runner::jobs(void) const {
+    return jobs_;
+}
@@ -8,7 +8,9 @@
 #include "code_macro.hpp"
 #include <stdlib.h>
 #include <string>
-#include <iostream>
+#include <vector>
+#include <utility>
+#include "gena_abi.h"
 
 // Constants.
 
@@ -16,25 +18,69 @@
 // Constructor.
 code_macro::code_macro(size_t op_code, \
                        std::vector<std::string> operand_template, \
-                       func_ptr func, size_t num_inst_bits) : \
+                       func_ptr func, gena_encode_fn encoder, \
+                       gena_encode_batch_fn batch_encoder, \
+                       size_t num_inst_bits) : \
                        op_code_(op_code), operand_template_(operand_template), \
-                       func_(func), num_inst_bits_(num_inst_bits) {};
+                       func_(func), encoder_(encoder), \
+                       batch_encoder_(batch_encoder), \
+                       num_inst_bits_(num_inst_bits), \
+                       matcher_(operand_template) {};
 
 // Destructor
 code_macro::~code_macro() {};
 
 // Public functions.
+bool code_macro::encode(const gena_operands& ops, uint64_t& out) const {
+    if (encoder_ != NULL) {
+        return encoder_(&ops, &out) == GENA_ENCODE_OK;
+    }
+    if (func_ == NULL) {
+        return false;
+    }
+    // The string ABI takes the values as text from the last operand to the
+    // first. Symbols and the program counter are passed as their value and
+    // everything else as written.
+    std::vector<std::string> args;
+    args.reserve(ops.count);
+    for (size_t i = ops.count; i > 0; i--) {
+        const gena_operand& op = ops.operands[i - 1];
+        if ((op.kind == GENA_OPERAND_SYMBOL) || (op.kind == GENA_OPERAND_PC)) {
+            args.push_back(std::to_string(static_cast<size_t>(op.value)));
+        }
+        else {
+            args.emplace_back(op.text, op.text_len);
+        }
+    }
+    try {
+        out = func_(op_code_, std::move(args));
+    }
+    catch (const std::exception& e) {
+        return false;
+    }
+    return out != std::string::npos;
+}
+
 // Accessors 
-size_t code_macro::op_code(void) {
+size_t code_macro::op_code(void) const {
     return op_code_;
 }
-std::vector<std::string> code_macro::operand_template(void) {
+const std::vector<std::string>& code_macro::operand_template(void) const {
     return operand_template_;
 }
-code_macro::func_ptr code_macro::func(void) {
+code_macro::func_ptr code_macro::func(void) const {
     return func_;
 }
-size_t code_macro::num_inst_bits(void) {
+gena_encode_fn code_macro::encoder(void) const {
+    return encoder_;
+}
+gena_encode_batch_fn code_macro::batch_encoder(void) const {
+    return batch_encoder_;
+}
+size_t code_macro::num_inst_bits(void) const {
     return num_inst_bits_;
 }
+const op_matcher& code_macro::matcher(void) const {
+    return matcher_;
+}
 
@@ -0,0 +1,113 @@
+// diagnostics.cpp
+// C++ file for the diagnostics class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "diagnostics.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <mutex>
+#include <map>
+#include <pthread.h>
+#include <cstdlib>
+
+// Constants.
+// The buffer is written once it holds this many bytes.
+const std::streamoff DIAG_BUFFER_SIZE = 64 * 1024;
+const char *DIAG_PREFIXES[NUM_DIAG_LEVELS] = {"", "Warning: ", "Error: "};
+
+// Constructor.
+diagnostics::diagnostics() : min_level_(DIAG_INFO), target_(NULL) {}
+
+// Public functions.
+diagnostics& diagnostics::global(void) {
+    static diagnostics instance;
+    // Write what is buffered when the process exits, including exits on
+    // errors.
+    static int registered = std::atexit([]() {
+        diagnostics::global().flush();
+    });
+    (void)registered;
+    // A process forked while another thread reports gets the diagnostics
+    // unlocked, and with nothing buffered that the parent writes as well.
+    static int forks = pthread_atfork([]() {
+        instance.mutex_.lock();
+        instance.flush_buffer();
+    }, []() {
+        instance.mutex_.unlock();
+    }, []() {
+        instance.mutex_.unlock();
+    });
+    (void)forks;
+    return instance;
+}
+
+bool diagnostics::enabled(diag_level level) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return level >= min_level_;
+}
+
+void diagnostics::set_min_level(diag_level level) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    min_level_ = level;
+}
+
+void diagnostics::flush(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_buffer();
+}
+
+std::map<std::string, uint64_t> diagnostics::counts(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return counts_;
+}
+
+void diagnostics::reset_counts(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counts_.clear();
+}
+
+// Helper functions.
+void diagnostics::begin(const diag_record& record) {
+    std::ostream* stream = (record.level == DIAG_ERROR) ? &std::cerr : \
+                           &std::clog;
+    if (stream != target_) {
+        flush_buffer();
+        target_ = stream;
+    }
+    // Messages start in decimal whatever the last one left set.
+    buffer_.flags(std::ios_base::dec | std::ios_base::skipws);
+    buffer_.fill(' ');
+    buffer_ << DIAG_PREFIXES[record.level];
+}
+
+void diagnostics::end(const diag_record& record) {
+    if (record.line != 0) {
+        buffer_ << " on line " << std::dec << record.line;
+        if (record.column != 0) {
+            buffer_ << " column " << record.column;
+        }
+    }
+    if (!record.file.empty()) {
+        buffer_ << " in file " << record.file;
+    }
+    buffer_ << '\n';
+    if (buffer_.tellp() >= DIAG_BUFFER_SIZE) {
+        flush_buffer();
+    }
+}
+
+void diagnostics::flush_buffer(void) {
+    if (target_ == NULL) {
+        return;
+    }
+    const std::string text = buffer_.str();
+    target_->write(text.data(), text.size());
+    target_->flush();
+    buffer_.str("");
+    target_ = NULL;
+}
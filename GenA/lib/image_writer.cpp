@@ -0,0 +1,232 @@
+// image_writer.cpp
+// C++ file for the image_writer class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "image_writer.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+
+// Constants.
+const size_t BITS_PER_BYTE = 8;
+const size_t SIZE_BITS = sizeof(size_t) * BITS_PER_BYTE;
+// The most data bytes in one record.
+const size_t RECORD_DATA_BYTES = 16;
+const uint8_t HEX_DATA = 0x00;
+const uint8_t HEX_END = 0x01;
+const uint8_t HEX_EXTENDED_LINEAR = 0x04;
+const size_t HEX_SEGMENT_BYTES = 0x10000;
+const std::string SREC_HEADER = "gena";
+const uint8_t BINARY_FILL = 0xFF;
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+// Constructor.
+image_writer::image_writer(output_format format, size_t word_bits, \
+                           bool little_endian, size_t unit_bits) : \
+                           format_(format), \
+                           word_bytes_(std::max<size_t>(1, (word_bits + \
+                                       BITS_PER_BYTE - 1) / BITS_PER_BYTE)), \
+                           little_endian_(little_endian), \
+                           unit_bytes_(unit_bits / BITS_PER_BYTE) {}
+
+// Destructor
+image_writer::~image_writer() {};
+
+// Public functions.
+void image_writer::add(size_t word_address, size_t value, size_t num_bits) {
+    size_t word_bits = word_bytes_ * BITS_PER_BYTE;
+    size_t num_words = std::max<size_t>(1, (num_bits + word_bits - 1) / \
+                                        word_bits);
+    size_t address = word_address * word_bytes_;
+    size_t total_bits = num_words * word_bits;
+
+    // Continue the last run if the value starts where it ends.
+    if (runs_.empty() || (runs_.back().address + runs_.back().bytes.size() != \
+                          address)) {
+        runs_.push_back({address, {}});
+    }
+    std::vector<uint8_t>& bytes = runs_.back().bytes;
+    size_t num_bytes = num_words * word_bytes_;
+    size_t unit_bytes = (unit_bytes_ == 0) ? num_bytes : unit_bytes_;
+    // Write every unit from the most significant down, a little endian unit
+    // from its least significant byte up. A short last unit is its own size.
+    for (size_t unit = 0; unit < num_bytes; unit += unit_bytes) {
+        size_t unit_len = std::min(unit_bytes, num_bytes - unit);
+        for (size_t i = 0; i < unit_len; i++) {
+            size_t byte = unit + (little_endian_ ? unit_len - 1 - i : i);
+            size_t shift = total_bits - (byte + 1) * BITS_PER_BYTE;
+            bytes.push_back((shift < SIZE_BITS) ? (value >> shift) & 0xFF : 0);
+        }
+    }
+}
+
+bool image_writer::write(std::ostream& file) const {
+    std::string out;
+
+    switch (format_) {
+        case FORMAT_INTEL_HEX:
+            format_intel_hex(out);
+            break;
+        case FORMAT_SREC:
+            format_srec(out);
+            break;
+        case FORMAT_BINARY:
+            format_binary(out);
+            break;
+        default:
+            return false;
+    }
+    file.write(out.data(), out.size());
+    return static_cast<bool>(file);
+}
+
+output_format image_writer::parse_format(const std::string& name) {
+    for (size_t i = 0; i < FORMAT_NAMES.size(); i++) {
+        if (FORMAT_NAMES.at(i) == name) {
+            return static_cast<output_format>(i);
+        }
+    }
+    return FORMAT_INVALID;
+}
+
+// Accessors
+size_t image_writer::num_bytes(void) const {
+    size_t total = 0;
+    for (const byte_run& run : runs_) {
+        total += run.bytes.size();
+    }
+    return total;
+}
+
+// Helper functions.
+void image_writer::format_intel_hex(std::string& out) const {
+    size_t segment = 0;
+    for (const byte_run& run : runs_) {
+        size_t pos = 0;
+        while (pos < run.bytes.size()) {
+            size_t address = run.address + pos;
+            // Records may not cross a 64K boundary, an extended linear address
+            // record gives the upper 16 bits of the addresses after it.
+            size_t len = std::min({RECORD_DATA_BYTES, run.bytes.size() - pos, \
+                                   HEX_SEGMENT_BYTES - \
+                                   (address % HEX_SEGMENT_BYTES)});
+            if (address / HEX_SEGMENT_BYTES != segment) {
+                segment = address / HEX_SEGMENT_BYTES;
+                uint8_t upper[] = {static_cast<uint8_t>(segment >> 8), \
+                                   static_cast<uint8_t>(segment)};
+                hex_record(out, HEX_EXTENDED_LINEAR, 0, upper, sizeof(upper));
+            }
+            hex_record(out, HEX_DATA, address % HEX_SEGMENT_BYTES, \
+                       run.bytes.data() + pos, len);
+            pos += len;
+        }
+    }
+    hex_record(out, HEX_END, 0, NULL, 0);
+}
+
+void image_writer::format_srec(std::string& out) const {
+    size_t end = runs_.empty() ? 0 : runs_.back().address + \
+                                     runs_.back().bytes.size();
+    size_t address_bytes;
+    char data_type;
+    char end_type;
+    size_t num_records = 0;
+
+    // Use the smallest address size that holds every address.
+    if (end <= 0x10000) {
+        address_bytes = 2;
+        data_type = '1';
+        end_type = '9';
+    }
+    else if (end <= 0x1000000) {
+        address_bytes = 3;
+        data_type = '2';
+        end_type = '8';
+    }
+    else {
+        address_bytes = 4;
+        data_type = '3';
+        end_type = '7';
+    }
+    srec_record(out, '0', 2, 0, \
+                reinterpret_cast<const uint8_t*>(SREC_HEADER.data()), \
+                SREC_HEADER.size());
+    for (const byte_run& run : runs_) {
+        for (size_t pos = 0; pos < run.bytes.size(); \
+             pos += RECORD_DATA_BYTES) {
+            srec_record(out, data_type, address_bytes, run.address + pos, \
+                        run.bytes.data() + pos, \
+                        std::min(RECORD_DATA_BYTES, run.bytes.size() - pos));
+            num_records++;
+        }
+    }
+    // The count record holds the number of data records in its address.
+    if (num_records <= 0xFFFF) {
+        srec_record(out, '5', 2, num_records, NULL, 0);
+    }
+    else {
+        srec_record(out, '6', 3, num_records, NULL, 0);
+    }
+    srec_record(out, end_type, address_bytes, 0, NULL, 0);
+}
+
+void image_writer::format_binary(std::string& out) const {
+    if (runs_.empty()) {
+        return;
+    }
+    // The file starts at the lowest address and gaps between runs are filled
+    // as erased memory.
+    size_t base = runs_.front().address;
+    for (const byte_run& run : runs_) {
+        out.append(run.address - base - out.size(), BINARY_FILL);
+        out.append(run.bytes.begin(), run.bytes.end());
+    }
+}
+
+void image_writer::hex_record(std::string& out, uint8_t type, \
+                              uint16_t address, const uint8_t* data, \
+                              size_t len) {
+    uint8_t sum = len + (address >> 8) + (address & 0xFF) + type;
+    out += ':';
+    append_byte(out, len);
+    append_byte(out, address >> 8);
+    append_byte(out, address & 0xFF);
+    append_byte(out, type);
+    for (size_t i = 0; i < len; i++) {
+        append_byte(out, data[i]);
+        sum += data[i];
+    }
+    append_byte(out, -sum);
+    out += '\n';
+}
+
+void image_writer::srec_record(std::string& out, char type, \
+                               size_t address_bytes, size_t address, \
+                               const uint8_t* data, size_t len) {
+    uint8_t count = address_bytes + len + 1;
+    uint8_t sum = count;
+    out += 'S';
+    out += type;
+    append_byte(out, count);
+    for (size_t i = address_bytes; i > 0; i--) {
+        uint8_t byte = address >> ((i - 1) * BITS_PER_BYTE);
+        append_byte(out, byte);
+        sum += byte;
+    }
+    for (size_t i = 0; i < len; i++) {
+        append_byte(out, data[i]);
+        sum += data[i];
+    }
+    append_byte(out, ~sum);
+    out += '\n';
+}
+
+void image_writer::append_byte(std::string& out, uint8_t byte) {
+    out += HEX_DIGITS[byte >> 4];
+    out += HEX_DIGITS[byte & 0xF];
+}
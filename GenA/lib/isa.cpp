@@ -10,6 +10,11 @@
 #include "isa.hpp"
 #include "asm_line.hpp"
 #include "code_macro.hpp"
+#include "lib_cache.hpp"
+#include "user_lib.hpp"
+#include "mnemonic_table.hpp"
+#include "line_lexer.hpp"
+#include "gena_abi.h"
 #include <stdlib.h>
 #include <string>
 #include <unordered_map>
@@ -20,8 +25,12 @@
 #include <sstream>
 #include <cstdlib>
 #include <algorithm>
-#include <dlfcn.h>
+#include <memory>
 #include <cctype>
+#include <filesystem>
+#include <chrono>
+#include <stdexcept>
+#include "diagnostics.hpp"
 
 // Constants.
 const size_t PRINC_NUM_MEM = 1;
@@ -29,10 +38,6 @@ const size_t HARV_NUM_MEM = 2;
 const size_t NUM_STYLE_EL = 3;
 const std::string USER_LIB_NAME = \
                   "user_lib";
-const std::vector<std::string> STYLE_ELEMENTS = {"label", "op_name", "operand"};
-const size_t OP_ELEMENT_IDX = 2;
-const size_t OP_NAME_ELEMENT_IDX = 1;
-const size_t LABEL_ELEMENT_IDX = 0;
 const size_t LINE_NUM_START = 4; 
 const size_t OP_NAME_IDX = 0;                                                 
 const size_t OP_CODE_IDX = 1;
@@ -41,11 +46,30 @@ const size_t OP_TEMP_IDX = 2;
 const size_t FUNC_REV_IDX = 2;
 const size_t NUM_BITS_REV_IDX = 1;
 const std::string COMMENT = ";";
-const std::string SYMBOL = "Sym";
-const std::string VALUE = "Val";
+// Relaxation lines, .relax <long op> <short op> <min words> <max words>.
+const std::string RELAX = ".relax";
+const size_t RELAX_SIZE = 5;
+const size_t RELAX_LONG_IDX = 1;
+const size_t RELAX_SHORT_IDX = 2;
+const size_t RELAX_MIN_IDX = 3;
+const size_t RELAX_MAX_IDX = 4;
+// Byte order lines, .endian <big|little> <unit bits>.
+const std::string ENDIAN = ".endian";
+const size_t ENDIAN_SIZE = 3;
+const size_t ENDIAN_ORDER_IDX = 1;
+const size_t ENDIAN_UNIT_IDX = 2;
+const std::string ENDIAN_BIG = "big";
+const std::string ENDIAN_LITTLE = "little";
+const size_t BITS_PER_BYTE = 8;
+const std::string GENA_ABI_VERSION_SYMBOL = "gena_abi_version";
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
 
 // Constructor.
-isa::isa(std::string isa_file_path) {
+isa::isa(std::string isa_file_path, lib_cache& user_lib_cache) : \
+         binary_abi_(false), fingerprint_(0), load_times_({0, 0, 0}), \
+         match_attempts_(0), little_endian_(false), endian_unit_bits_(0) {
+    auto start = std::chrono::steady_clock::now();
 	std::string isa_line;
 	std::vector<std::string> isa_line_data;
     size_t line_num;
@@ -56,8 +80,10 @@ isa::isa(std::string isa_file_path) {
 	// an error message and exit the program. 
 	std::ifstream isa_file(isa_file_path);
 	if (!isa_file) {
-		std::cerr << "Error: Unable to open file: " << isa_file_path \
-				  << std::endl;
+        diagnostics::global().report({DIAG_ERROR, "isa-open", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Unable to open file: " << isa_file_path;
+        });
 		exit(EXIT_FAILURE);
 	}
     
@@ -73,12 +99,14 @@ isa::isa(std::string isa_file_path) {
 	// Parse the first line of the ISA file and set up the DLL with specified
 	// C++ file path.
 	if (isa_line != "") {
-		compile_to_shared_lib(isa_line);
+		compile_to_shared_lib(isa_line, user_lib_cache);
 	}
 	// Display error message and exit program if first line is missing and exit.
 	else {
-		std::cerr << "Error: Missing C++ file path in " << "ISA file: " << \
-        isa_file_path << std::endl; 
+        diagnostics::global().report({DIAG_ERROR, "isa-source", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Missing C++ file path in ISA file: " << isa_file_path;
+        });
 		exit(EXIT_FAILURE);
 	}
 
@@ -101,8 +129,11 @@ isa::isa(std::string isa_file_path) {
 		// If the fourth line does not contain all needed elements, display an
 		// error message and exit.
 		if (isa_line_data.size() != NUM_STYLE_EL) {
-			std::cerr << "Error: Missing line elements on syntax line the " << \
-		    	         "ISA file:" << isa_file_path << std::endl; 
+            diagnostics::global().report({DIAG_ERROR, "isa-style", "", 0, 0}, \
+                                         [&](std::ostream& out) {
+                out << "Missing line elements on syntax line the ISA " \
+                    << "file: " << isa_file_path;
+            });
 			exit(EXIT_FAILURE);
 		}
 		// Otherwise check the validity of the style and update the data.
@@ -115,19 +146,25 @@ isa::isa(std::string isa_file_path) {
                 }
             }
             style_ = isa_line_data;
+            lexer_ = line_lexer(style_);
         }
         // Display error message and exit if style is not valid.
         else {
-            std::cerr << "Error: Invalid style line in ISA file: " << \
-                          isa_file_path << std::endl; 
+            diagnostics::global().report({DIAG_ERROR, "isa-style", "", 0, 0}, \
+                                         [&](std::ostream& out) {
+                out << "Invalid style line in ISA file: " << isa_file_path;
+            });
             exit(EXIT_FAILURE);
 	    }
 	}
     // Display error message and exit program if fourth line is missing and 
     // exit.
 	else {
-		std::cerr << "Error: Missing memory sizes in the ISA " << "file: " << \
-        isa_file_path << std::endl; 
+        diagnostics::global().report({DIAG_ERROR, "isa-style", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Missing style line in the ISA file: " << \
+               isa_file_path;
+        });
 		exit(EXIT_FAILURE);
 	}
 
@@ -140,10 +177,45 @@ isa::isa(std::string isa_file_path) {
             continue;
         }
         isa_line_data = split_by_spaces(isa_line);
-        parse_isa_code_macro(isa_line_data, isa_file_path, line_num);
+        if (!isa_line_data.empty() && \
+            (strip_and_lower(isa_line_data.at(0)) == RELAX)) {
+            parse_isa_relax(isa_line_data, isa_file_path, line_num);
+        }
+        else if (!isa_line_data.empty() && \
+                 (strip_and_lower(isa_line_data.at(0)) == ENDIAN)) {
+            parse_isa_endian(isa_line_data, isa_file_path, line_num);
+        }
+        else {
+            parse_isa_code_macro(isa_line_data, isa_file_path, line_num);
+        }
         line_num++;
     }
-    std::clog << "\nISA file " << isa_file_path << " parsed." << std::endl;
+    // Code macros whose functions can not be found can not be encoded, so
+    // the ISA is not loaded.
+    if (!report_unresolved(isa_file_path)) {
+        exit(EXIT_FAILURE);
+    }
+    build_overloads();
+    build_relax_forms(isa_file_path);
+    // The library name holds the hash of the user function file it was built
+    // from, its directory depends on the cache used.
+    std::ifstream isa_text(isa_file_path, std::ios::binary);
+    std::ostringstream contents;
+    contents << isa_text.rdbuf();
+    fingerprint_ = FNV_OFFSET;
+    for (unsigned char c : contents.str() + '\0' + \
+         std::filesystem::path(user_function_path_).filename().string()) {
+        fingerprint_ ^= c;
+        fingerprint_ *= FNV_PRIME;
+    }
+    // Everything not spent on the user library was spent parsing.
+    load_times_.parse = std::chrono::duration<double>( \
+                        std::chrono::steady_clock::now() - start).count() - \
+                        load_times_.compile - load_times_.load;
+    diagnostics::global().report({DIAG_INFO, "isa-parsed", "", 0, 0}, \
+                                 [&](std::ostream& out) {
+        out << "\nISA file " << isa_file_path << " parsed.";
+    });
     isa_file.close();
 }
 
@@ -151,162 +223,152 @@ isa::isa(std::string isa_file_path) {
 isa::~isa() {};
 
 // Public functions.
-asm_line isa::parse_asm(std::string line, std::string file_path) {
-    std::string label;
-    std::string op_name;
-    std::string operand;
-    std::string text;
-    std::string asm_file_path;
-    std::string element;
-    size_t cutoff;
-
-    text = line;
-    line = line.erase(0, line.find_first_not_of(' '));
-    // If the asm line is empty return an invalid line.
-    if (line.empty()) {
-        return asm_line(ASM_INVALID, ASM_INVALID, ASM_INVALID, ASM_INVALID, \
-                        ASM_INVALID);
-    }
-    asm_file_path = file_path;
-    // Go through each line elements.
-    for (size_t i = 0; i < NUM_STYLE_EL; i++) {
-        // Find where the next closest present element is. This cuts off where 
-        // to look for the current element.
-        cutoff = std::string::npos;
-        for (size_t j = i + 1; j < NUM_STYLE_EL; j++) {
-            element = style_.at(j);
-            if (line.find(element.back()) < cutoff) {
-                cutoff = line.find(element.back());
-            }
+asm_line isa::parse_asm(char* line, size_t len, std::string_view text, \
+                        std::string_view file_path, arena& storage, \
+                        std::ostream& diag) const {
+    lexed_line elements;
+
+    // Split the line into its elements in place. Lines with no elements are
+    // kept as empty lines.
+    lexer_.lex(line, len, elements);
+
+    // Lines with an operation are matched to their code macro here, once, and
+    // the line keeps the macro and its arguments.
+    const code_macro* macro = NULL;
+    op_arg args[OP_MAX_ARGS];
+    size_t num_args = 0;
+    if (!elements.op_name.empty() || !elements.operand.empty()) {
+        macro = code_mac(elements.op_name, elements.operand, args, num_args);
+        // If the asm line has no matching code macro display an error message
+        // and invalidate the asm_line.
+        if (macro == NULL) {
+            diag << "No code macro found for " << elements.op_name << " " \
+                 << elements.operand;
+            return asm_line(ASM_INVALID, ASM_INVALID, ASM_INVALID, \
+                            ASM_INVALID, ASM_INVALID);
         }
-
-        // Check for which element to update.
-        element = style_.at(i);
-        element_check(element, STYLE_ELEMENTS.at(LABEL_ELEMENT_IDX), label, \
-                      line, cutoff);
-        element_check(element, STYLE_ELEMENTS.at(OP_NAME_ELEMENT_IDX), \
-                      op_name, line, cutoff);
-        element_check(element, STYLE_ELEMENTS.at(OP_ELEMENT_IDX), operand, \
-                      line, cutoff);
-    }
-
-    label = strip_and_lower(label);
-    op_name = strip_and_lower(op_name);
-    operand = strip_and_lower(operand);
-
-    // If the asm line has no matching code macro display an error message and
-    // invalidate the asm_line.
-    if ((operand != "") && (code_mac(op_name, operand).num_inst_bits() == \
-                            ISA_INVALID)) {
-        std::cerr << "Error: No code macro found for " << op_name << " " << \
-        operand << std::endl;
-        return asm_line(ASM_INVALID, ASM_INVALID, ASM_INVALID, ASM_INVALID, \
-                        ASM_INVALID);
     }
-    return asm_line(asm_file_path, text, label, op_name, operand);
+    return asm_line(file_path, text, elements.label, elements.op_name, \
+                    elements.operand, macro, storage.copy(args, num_args), \
+                    num_args);
 }
 
-code_macro isa::code_mac(std::string op_name, std::string operand) {
-    std::vector<std::string> op_temp;
-    std::vector<std::string> args;
-    code_macro return_macro = code_macro(ISA_INVALID, \
-    std::vector<std::string>(), NULL, ISA_INVALID);
-    auto macros = code_map_.equal_range(op_name);
-    for (auto macro = macros.first; macro != macros.second; ++macro) {
-        op_temp = macro->second.operand_template();
-        args = op_match(op_temp, operand);
-        if (!args.empty()) {
-            return_macro = macro->second;
-            return_macro.arguments = args;
+const code_macro* isa::code_mac(std::string_view op_name, \
+                                std::string_view operand, op_arg* args, \
+                                size_t& num_args) const {
+    size_t group = mnemonics_.find(op_name);
+    // Return NULL if the operation does not exist.
+    if (group == MNEMONIC_NONE) {
+        return NULL;
+    }
+    // The first overload that matches is the most specific one. Overloads that
+    // start with a symbol are dispatched on its first character.
+    char lead = operand.empty() ? 0 : operand.front();
+    const code_macro* first = macros_.data() + overloads_[group].first;
+    const code_macro* last = first + overloads_[group].second;
+    uint64_t attempts = 0;
+    for (const code_macro* macro = first; macro != last; ++macro) {
+        const op_matcher& matcher = macro->matcher();
+        if ((matcher.lead() != 0) && (matcher.lead() != lead)) {
+            continue;
+        }
+        attempts++;
+        num_args = matcher.match(operand, args);
+        if (num_args != OP_NO_MATCH) {
+            match_attempts_.fetch_add(attempts, std::memory_order_relaxed);
+            return macro;
         }
     }
-    // Return invalid code macro and display error message if none found.
-    return return_macro;
+    match_attempts_.fetch_add(attempts, std::memory_order_relaxed);
+    // Return NULL if none found.
+    num_args = 0;
+    return NULL;
 }
 
 // Accessors	
-std::vector<size_t> isa::word_sizes(void) {
+const std::vector<size_t>& isa::word_sizes(void) const {
     return word_sizes_;
 }
-std::vector<size_t> isa::mem_sizes(void) {
+const std::vector<size_t>& isa::mem_sizes(void) const {
     return mem_sizes_;
 }
-size_t isa::harv_not_princ(void) {
+size_t isa::harv_not_princ(void) const {
     return harv_not_princ_;
 }
+const std::string& isa::user_source_path(void) const {
+    return user_source_path_;
+}
+uint64_t isa::fingerprint(void) const {
+    return fingerprint_;
+}
+size_t isa::macro_index(const code_macro* macro) const {
+    return macro - macros_.data();
+}
+const code_macro* isa::macro_at(size_t index) const {
+    return (index < macros_.size()) ? &macros_.at(index) : NULL;
+}
+const isa_load_times& isa::load_times(void) const {
+    return load_times_;
+}
+const std::vector<relax_form>& isa::relax_forms(const code_macro* macro) \
+                                                const {
+    static const std::vector<relax_form> none;
+    size_t index = macro_index(macro);
+    return (index < relax_forms_.size()) ? relax_forms_.at(index) : none;
+}
+uint64_t isa::match_attempts(void) const {
+    return match_attempts_.load(std::memory_order_relaxed);
+}
+bool isa::little_endian(void) const {
+    return little_endian_;
+}
+size_t isa::endian_unit_bits(void) const {
+    return endian_unit_bits_;
+}
 		
 
 // Helper functions.
-std::vector<std::string> isa::op_match(std::vector<std::string> op_temp, \
-                                       std::string op) {
-    bool prev_val = false;
-    std::vector<std::string> arguments;
-    // Go through each sting in the template.
-    if (!op_temp.empty()) {
-        for (std::string sym : op_temp) {
-            if (sym.find(SYMBOL) == 0) {
-                sym = sym.substr(SYMBOL.length());
-                // If for any SYMBOL symbol in the template the string designated to
-                // it is not in the remaining operand, return false.
-                if (!op.find(sym)) {
-                    return std::vector<std::string>();;
-                }
-                // If the string is found, and the previous symbol was a value, the
-                // operand can be cut off to the string symbol and that value can
-                // be added to the vector of args.
-                else if (prev_val) {
-                    arguments.push_back(op.substr(0, op.find(sym)));
-                    op = op.substr(op.find(sym) + sym.length());
-                }
-                // If the previous symbol was not a value it must be checked that 
-                // the string SYMBOL is at the start of the line before cutting it
-                else if (op.find(sym) == 0) {
-                    op = op.substr(op.find(sym) + sym.length());
-                }
-                // If its not at the start and the symbol before was not a value 
-                // then the operand does not match.
-                else {
-                    return std::vector<std::string>();
-                }
-                prev_val = false;
-            }
-            else if ((sym == VALUE) || (sym == PC)) {
-                prev_val = true;
-            }
+void isa::build_overloads(void) {
+    std::vector<size_t> order(macros_.size());
+    std::vector<code_macro> grouped;
+    std::vector<std::string> names;
+
+    for (size_t i = 0; i < order.size(); i++) {
+        order.at(i) = i;
+    }
+    // Group the code macros by operation name. Within a name templates that
+    // start with a symbol come first since they can only match operands
+    // starting with it, then templates with more symbols since they are more
+    // specific than templates that could capture the same operand.
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (macro_names_.at(a) != macro_names_.at(b)) {
+            return macro_names_.at(a) < macro_names_.at(b);
         }
-        // Since the op has been cut off of all symbols and values between them, the
-        // remaining operand must either be an empty string, or the last symbol must
-        // be a value for the operand to match the template. If its a value add it,
-        // if its an empty string add it only if theres no arguments.
-        if ((op_temp.back() == VALUE) || ((op == "") && arguments.empty())) {
-            arguments.push_back(op);
+        const op_matcher& a_matcher = macros_.at(a).matcher();
+        const op_matcher& b_matcher = macros_.at(b).matcher();
+        bool a_lead = a_matcher.lead() != 0;
+        bool b_lead = b_matcher.lead() != 0;
+        if (a_lead != b_lead) {
+            return a_lead;
         }
-        return arguments;
-    }
-    return std::vector<std::string>();
-}
+        return a_matcher.num_symbol_chars() > b_matcher.num_symbol_chars();
+    });
 
-void isa::element_check(std::string element, std::string ref, std::string& \
-                        status, std::string& line, size_t cutoff) {
-    // Delimiter index.
-    size_t i;
-
-    // Any element may be delimited by the end of the line.
-    i =  std::min(line.find(element.back()), line.size());
-    // The status string is updated with the string leading to its elements 
-    // delimiter if its equal to the reference element and the delimiter is not
-    // past the cut off.
-    if ((element.substr(0, element.size() - 1) == ref) && (i < cutoff)) {
-        status = line.substr(0, i);
-        line = line.substr(std::min(i + 1, line.size()));
-        size_t start = line.find_first_not_of(' ');
-        if (start != std::string::npos) {
-            line = line.substr(start);
+    grouped.reserve(macros_.size());
+    for (size_t i : order) {
+        if (names.empty() || (names.back() != macro_names_.at(i))) {
+            names.push_back(macro_names_.at(i));
+            overloads_.push_back({grouped.size(), 0});
         }
+        grouped.push_back(macros_.at(i));
+        overloads_.back().second++;
     }
+    macros_ = std::move(grouped);
+    macro_names_.clear();
+    mnemonics_.build(names);
 }
 
-std::vector<std::string> isa::split_by_spaces(const std::string& str) {
+std::vector<std::string> isa::split_by_spaces(const std::string& str) const {
     std::vector<std::string> result;
     std::istringstream stream(str);
     std::string word;
@@ -318,14 +380,37 @@ std::vector<std::string> isa::split_by_spaces(const std::string& str) {
     return result;
 }
 
-void isa::compile_to_shared_lib(const std::string& source_file) {
-    user_function_path_ = source_file.substr(0, source_file.find_last_of('.'));
-    std::string command = "g++ -shared -o " + user_function_path_ + " -fPIC " \
-                          + source_file;
-    if (system(command.c_str()) != 0) {
-        std::cerr << "Error: Can not compile the source file: " << source_file \
-                     << std::endl;
-    } 
+void isa::compile_to_shared_lib(const std::string& source_file, \
+                                lib_cache& user_lib_cache) {
+    // The cache displays the error message if the file can not be compiled.
+    user_source_path_ = source_file;
+    auto start = std::chrono::steady_clock::now();
+    user_function_path_ = user_lib_cache.shared_lib(source_file);
+    auto compiled = std::chrono::steady_clock::now();
+    load_times_.compile = std::chrono::duration<double>(compiled - \
+                                                        start).count();
+    // Open the library once, every code macro resolves its function from it.
+    user_lib_ = std::make_unique<user_lib>(user_function_path_);
+    // Libraries that export their ABI version use binary encoders, all others
+    // use the string ABI.
+    gena_abi_version_fn version = reinterpret_cast<gena_abi_version_fn>( \
+                                  user_lib_->symbol(GENA_ABI_VERSION_SYMBOL, \
+                                                    false));
+    if (version != NULL) {
+        if (version() != GENA_ENCODER_ABI_VERSION) {
+            diagnostics::global().report( \
+                {DIAG_ERROR, "abi-version", "", 0, 0}, \
+                [&](std::ostream& out) {
+                out << "User library " << user_function_path_ << " uses " \
+                    << "encoder ABI version " << version() << ", expected " \
+                    << GENA_ENCODER_ABI_VERSION;
+            });
+            exit(EXIT_FAILURE);
+        }
+        binary_abi_ = true;
+    }
+    load_times_.load += std::chrono::duration<double>( \
+                        std::chrono::steady_clock::now() - compiled).count();
     return;
 }
 
@@ -358,10 +443,12 @@ void isa::parse_isa_mem_data(std::ifstream& isa_file, \
                     // Display error message and exit if string is not a 
                     // positive integer.
                     catch (const std::exception& e) {
-                        std::cout << "Error: Invalid entry: " << \
-                                     isa_line_data.at(i) << " on word line " \
-                                     << "of ISA file: " << isa_file_path << \
-                                     std::endl;
+                        diagnostics::global().report( \
+                            {DIAG_ERROR, "isa-words", "", 0, 0}, \
+                            [&](std::ostream& out) {
+                            out << "Invalid entry: " << isa_line_data.at(i) << \
+                            " on word line of ISA file: " << isa_file_path;
+                        });
                         exit(EXIT_FAILURE);
                     }
 				}
@@ -375,10 +462,12 @@ void isa::parse_isa_mem_data(std::ifstream& isa_file, \
                     // Display error message and exit if string is not a 
                     // positive integer.
                     catch (const std::exception& e) {
-                        std::cout << "Error: Invalid entry: " << \
-                                     isa_line_data.at(i) << " on word line " \
-                                     << "of ISA file: " << isa_file_path << \
-                                     std::endl;
+                        diagnostics::global().report( \
+                            {DIAG_ERROR, "isa-words", "", 0, 0}, \
+                            [&](std::ostream& out) {
+                            out << "Invalid entry: " << isa_line_data.at(i) << \
+                            " on word line of ISA file: " << isa_file_path;
+                        });
                     exit(EXIT_FAILURE);
                     }
 				}
@@ -386,16 +475,22 @@ void isa::parse_isa_mem_data(std::ifstream& isa_file, \
 			// Display error message and exit if the wrong number of strings 
 			// are on the second line.
 			default:
-				std::cerr << "Error: Wrong number of word sizes on word " << \
-				             "line of the ISA file: " << isa_file_path << \
-							 std::endl; 
+                diagnostics::global().report( \
+                    {DIAG_ERROR, "isa-words", "", 0, 0}, \
+                    [&](std::ostream& out) {
+                    out << "Wrong number of word sizes on word line of the " \
+                        << "ISA file: " << isa_file_path;
+                });
 				exit(EXIT_FAILURE);
 		}
 	}
 	// Display error message and exit program if second line is missing.
 	else {
-		std::cerr << "Error: Missing word sizes on word line of the ISA " << \
-			         "file: " << isa_file_path << std::endl; 
+        diagnostics::global().report({DIAG_ERROR, "isa-words", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Missing word sizes on word line of the ISA file: " \
+                << isa_file_path;
+        });
 		exit(EXIT_FAILURE);
 	}
 
@@ -407,9 +502,11 @@ void isa::parse_isa_mem_data(std::ifstream& isa_file, \
 		// If the number of strings on this line is not consistent with the 
 		// previous line, display error message and exit program.
 		if ((harv_not_princ_ + 1) != isa_line_data.size()) {
-			std::cerr << "Error: Memory space number inconsistent " << \
-				         "word and size lines of the ISA file " << \
-		             	 isa_file_path << std::endl; 
+            diagnostics::global().report({DIAG_ERROR, "isa-memory", "", 0, 0}, \
+                                         [&](std::ostream& out) {
+                out << "Memory space number inconsistent word and size " \
+                    << "lines of the ISA file " << isa_file_path;
+            });
 			exit(EXIT_FAILURE);
 		}
 		// Otherwise save all the memory size data.
@@ -420,24 +517,29 @@ void isa::parse_isa_mem_data(std::ifstream& isa_file, \
             // Display error message and exit if string is not a 
             // positive integer.
             catch (const std::exception& e) {
-                std::cout << "Error: Invalid entry: " << \
-                                isa_line_data.at(i) << " in memory size " << \
-                                "line of ISA file: " << isa_file_path << \
-                                std::endl;
+                diagnostics::global().report( \
+                    {DIAG_ERROR, "isa-memory", "", 0, 0}, \
+                    [&](std::ostream& out) {
+                    out << "Invalid entry: " << isa_line_data.at(i) << \
+                    " in memory size line of ISA file: " << isa_file_path;
+                });
                 exit(EXIT_FAILURE);
             }
 		}
 	}
 	// Display error message and exit program if third line is missing.
 	else {
-		std::cerr << "Error: Missing memory sizes memory size line 3 of " << \
-		             "the ISA file: " << isa_file_path << std::endl; 
+        diagnostics::global().report({DIAG_ERROR, "isa-memory", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Missing memory sizes memory size line 3 of the " \
+                << "ISA file: " << isa_file_path;
+        });
 		exit(EXIT_FAILURE);
 	}
     return;
 }
 
-bool isa::valid_style(std::vector<std::string> style) {
+bool isa::valid_style(const std::vector<std::string>& style) const {
     std::string element;
     std::vector<std::string> found_elements;
     std::vector<char> found_delimiters;
@@ -457,33 +559,42 @@ bool isa::valid_style(std::vector<std::string> style) {
         // an error.
         if (std::find(STYLE_ELEMENTS.begin(), STYLE_ELEMENTS.end(), \
             element.substr(0, element.size() - 1)) == STYLE_ELEMENTS.end()) {
-            std::cerr << "Error: Invalid element: " << \
-            element.substr(0, element.size() - 1) << std::endl; 
+            diagnostics::global().report({DIAG_ERROR, "isa-style", "", 0, 0}, \
+                                         [&](std::ostream& out) {
+                out << "Invalid element: " << \
+                element.substr(0, element.size() - 1);
+            });
             valid = false;
         }
         // If the element has already been found display an error.
         if (std::find(found_elements.begin(), found_elements.end(), \
             element.substr(0, element.size() - 1)) != found_elements.end()) {
-            std::cerr << "Error: Duplicate element: " << \
-            element.substr(0, element.size() - 1) << std::endl; 
+            diagnostics::global().report({DIAG_ERROR, "isa-style", "", 0, 0}, \
+                                         [&](std::ostream& out) {
+                out << "Duplicate element: " << \
+                element.substr(0, element.size() - 1);
+            });
             valid = false;
         }
         // If the delimiter has already been found display an error.
         if (std::find(found_delimiters.begin(), found_delimiters.end(), \
             element.back()) != found_delimiters.end()) {
-            std::cerr << "Error: Duplicate delimiter: " << element.back() << \
-            std::endl; 
+            diagnostics::global().report({DIAG_ERROR, "isa-style", "", 0, 0}, \
+                                         [&](std::ostream& out) {
+                out << "Duplicate delimiter: " << element.back();
+            });
             valid = false;
         }
     }
     return valid;
 }
 
-void isa::parse_isa_code_macro(std::vector<std::string> isa_line_data, \
-                              std::string isa_file_path, size_t line_num) {
+void isa::parse_isa_code_macro(const std::vector<std::string>& isa_line_data, \
+                               const std::string& isa_file_path, \
+                               size_t line_num) {
     size_t op_code;
     std::vector<std::string> operand_template;
-    code_macro::func_ptr func;
+    void* func;
     size_t num_inst_bits;
     size_t len;
     std::string sym_val;
@@ -500,9 +611,11 @@ void isa::parse_isa_code_macro(std::vector<std::string> isa_line_data, \
         op_code = std::stoul(isa_line_data.at(OP_CODE_IDX));
     }
     catch (const std::exception& e) {
-        std::cerr << "Error: Invalid op code: " << \
-                    isa_line_data.at(OP_CODE_IDX) << " at line "<< line_num << \
-                    " of ISA " << "file: " << isa_file_path << std::endl;
+        diagnostics::global().report( \
+            {DIAG_ERROR, "macro-opcode", isa_file_path, line_num, 0}, \
+            [&](std::ostream& out) {
+            out << "Invalid op code: " << isa_line_data.at(OP_CODE_IDX);
+        });
         make = false;
     }
 
@@ -510,9 +623,11 @@ void isa::parse_isa_code_macro(std::vector<std::string> isa_line_data, \
         sym_val = isa_line_data.at(i);
         if ((sym_val.find(SYMBOL) != 0) && (sym_val != VALUE) && (sym_val != \
              PC)) {
-            std::cerr << "Error: Invalid symbol: " << sym_val << "at line " << \
-                         line_num << " of ISA file: " << isa_file_path << \
-                         std::endl;
+            diagnostics::global().report( \
+                {DIAG_ERROR, "macro-symbol", isa_file_path, line_num, 0}, \
+                [&](std::ostream& out) {
+                out << "Invalid symbol: " << sym_val;
+            });
             make = false;
         }
         else {
@@ -520,13 +635,12 @@ void isa::parse_isa_code_macro(std::vector<std::string> isa_line_data, \
         }
     }
 
-    func = (code_macro::func_ptr)load_function(user_function_path_, \
-                                 isa_line_data.at(len - FUNC_REV_IDX));
-    
+    // Unresolved functions are reported together once the file is parsed.
+    auto resolve_start = std::chrono::steady_clock::now();
+    func = user_lib_->symbol(isa_line_data.at(len - FUNC_REV_IDX));
     if (func == NULL) {
-        std::cerr << "Error: Invalid function " << \
-        isa_line_data.at(len - FUNC_REV_IDX) << " at line " << line_num << \
-        " of ISA file: " << isa_file_path << std::endl;
+        unresolved_lines_[isa_line_data.at(len - FUNC_REV_IDX)].push_back( \
+                                                                  line_num);
         make = false;
     }
 
@@ -535,9 +649,12 @@ void isa::parse_isa_code_macro(std::vector<std::string> isa_line_data, \
         num_inst_bits = std::stoul(isa_line_data.at(len - NUM_BITS_REV_IDX));
         }
     catch (const std::exception& e) {
-        std::cerr << "Error: Invalid number of bits: " << \
-                    isa_line_data.at(len - NUM_BITS_REV_IDX) << " at line " << \
-                    line_num << " of ISA file: " << isa_file_path << std::endl;
+        diagnostics::global().report( \
+            {DIAG_ERROR, "macro-bits", isa_file_path, line_num, 0}, \
+            [&](std::ostream& out) {
+            out << "Invalid number of bits: " << \
+                isa_line_data.at(len - NUM_BITS_REV_IDX);
+        });
         make = false;
     }
 
@@ -545,34 +662,178 @@ void isa::parse_isa_code_macro(std::vector<std::string> isa_line_data, \
     // Create the code macro and add it to the code map data member if all data
     // is good.
     if (make) {
-        code_macro isa_code_macro(op_code, operand_template, func, \
-                                num_inst_bits);
-        code_map_.insert({strip_and_lower(isa_line_data.at(OP_NAME_IDX)), \
-                                          isa_code_macro});
+        code_macro::func_ptr string_func = NULL;
+        gena_encode_fn encoder = NULL;
+        gena_encode_batch_fn batch_encoder = NULL;
+        if (binary_abi_) {
+            encoder = reinterpret_cast<gena_encode_fn>(func);
+            batch_encoder = reinterpret_cast<gena_encode_batch_fn>( \
+                            user_lib_->symbol(isa_line_data.at(len - \
+                                              FUNC_REV_IDX) + \
+                                              GENA_BATCH_SUFFIX, false));
+        }
+        else {
+            string_func = reinterpret_cast<code_macro::func_ptr>(func);
+        }
+        load_times_.load += std::chrono::duration<double>( \
+                            std::chrono::steady_clock::now() - \
+                            resolve_start).count();
+        code_macro isa_code_macro(op_code, operand_template, string_func, \
+                                  encoder, batch_encoder, num_inst_bits);
+        // The template compiles as long as it has few enough values.
+        if (!isa_code_macro.matcher().valid()) {
+            diagnostics::global().report( \
+                {DIAG_ERROR, "macro-values", isa_file_path, line_num, 0}, \
+                [&](std::ostream& out) {
+                out << "More than " << OP_MAX_ARGS << " values in operand " \
+                    << "template";
+            });
+            return;
+        }
+        macros_.push_back(isa_code_macro);
+        macro_names_.push_back(strip_and_lower(isa_line_data.at( \
+                                               OP_NAME_IDX)));
     }
     return;
 }
 
-code_macro::func_ptr isa::load_function(const std::string& lib_name, \
-                                        const std::string& func_name) {
-        void* handle = dlopen(lib_name.c_str(), RTLD_LAZY);
-        if (!handle) {
-            std::cerr << "Error: Cannot open library: " << dlerror() << std::endl;
-            return nullptr;
+void isa::parse_isa_relax(const std::vector<std::string>& isa_line_data, \
+                          const std::string& isa_file_path, size_t line_num) {
+    int64_t range[2];
+
+    if (isa_line_data.size() != RELAX_SIZE) {
+        diagnostics::global().report( \
+            {DIAG_ERROR, "isa-relax", isa_file_path, line_num, 0}, \
+            [&](std::ostream& out) {
+            out << "Relaxation line needs a long operation, a short " \
+                << "operation and its range";
+        });
+        return;
+    }
+    for (size_t i = 0; i < 2; i++) {
+        const std::string& entry = isa_line_data.at(RELAX_MIN_IDX + i);
+        try {
+            size_t used;
+            range[i] = std::stoll(entry, &used);
+            if (used != entry.size()) {
+                throw std::invalid_argument(entry);
+            }
+        }
+        catch (const std::exception& e) {
+            diagnostics::global().report( \
+                {DIAG_ERROR, "isa-relax", isa_file_path, line_num, 0}, \
+                [&](std::ostream& out) {
+                out << "Invalid relaxation range: " << entry;
+            });
+            return;
+        }
+    }
+    relax_lines_.push_back({strip_and_lower(isa_line_data.at(RELAX_LONG_IDX)), \
+                            strip_and_lower(isa_line_data.at( \
+                                            RELAX_SHORT_IDX)), \
+                            range[0], range[1], line_num});
+}
+
+void isa::parse_isa_endian(const std::vector<std::string>& isa_line_data, \
+                           const std::string& isa_file_path, \
+                           size_t line_num) {
+    std::string order;
+    size_t unit_bits = 0;
+
+    if (isa_line_data.size() == ENDIAN_SIZE) {
+        order = strip_and_lower(isa_line_data.at(ENDIAN_ORDER_IDX));
+        try {
+            size_t used;
+            const std::string& entry = isa_line_data.at(ENDIAN_UNIT_IDX);
+            unit_bits = std::stoul(entry, &used);
+            if (used != entry.size()) {
+                unit_bits = 0;
+            }
+        }
+        catch (const std::exception& e) {
+            unit_bits = 0;
         }
+    }
+    // The unit must be whole bytes.
+    if (((order != ENDIAN_BIG) && (order != ENDIAN_LITTLE)) || \
+        (unit_bits == 0) || (unit_bits % BITS_PER_BYTE != 0)) {
+        diagnostics::global().report( \
+            {DIAG_ERROR, "isa-endian", isa_file_path, line_num, 0}, \
+            [&](std::ostream& out) {
+            out << "Byte order line needs big or little and a unit of whole " \
+                << "bytes in bits";
+        });
+        return;
+    }
+    little_endian_ = (order == ENDIAN_LITTLE);
+    endian_unit_bits_ = unit_bits;
+}
 
-        dlerror(); // reset errors
-        code_macro::func_ptr func = (code_macro::func_ptr)dlsym(handle, func_name.c_str());
-        const char* dlsym_error = dlerror();
-        if (dlsym_error) {
-            std::cerr << "Error: " << dlsym_error << std::endl;
-            dlclose(handle);
-            return nullptr;
+void isa::build_relax_forms(const std::string& isa_file_path) {
+    relax_forms_.assign(macros_.size(), {});
+    for (const relax_line& line : relax_lines_) {
+        size_t long_group = mnemonics_.find(line.long_name);
+        size_t short_group = mnemonics_.find(line.short_name);
+        bool paired = false;
+        if ((long_group != MNEMONIC_NONE) && (short_group != MNEMONIC_NONE)) {
+            auto [long_first, long_count] = overloads_.at(long_group);
+            auto [short_first, short_count] = overloads_.at(short_group);
+            // The short form takes the arguments of the long form as they
+            // were matched, so the operand templates must be the same.
+            for (size_t i = long_first; i < long_first + long_count; i++) {
+                for (size_t j = short_first; j < short_first + short_count; \
+                     j++) {
+                    if ((macros_.at(j).operand_template() == \
+                         macros_.at(i).operand_template()) && \
+                        (macros_.at(j).num_inst_bits() < \
+                         macros_.at(i).num_inst_bits())) {
+                        relax_forms_.at(i).push_back({&macros_.at(j), \
+                                                      line.min, line.max});
+                        paired = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (!paired) {
+            diagnostics::global().report( \
+                {DIAG_ERROR, "isa-relax", isa_file_path, line.line_num, 0}, \
+                [&](std::ostream& out) {
+                out << "No shorter " << line.short_name << " code macro " \
+                    << "with the operand template of " << line.long_name;
+            });
         }
-        return func;
     }
+    // Forms are tried from the smallest up.
+    for (std::vector<relax_form>& forms : relax_forms_) {
+        std::stable_sort(forms.begin(), forms.end(), \
+                         [](const relax_form& a, const relax_form& b) {
+            return a.macro->num_inst_bits() < b.macro->num_inst_bits();
+        });
+    }
+    relax_lines_.clear();
+}
+
+bool isa::report_unresolved(const std::string& isa_file_path) {
+    // Nothing more to report if the library itself could not be opened.
+    if (user_lib_->unresolved().empty() || !user_lib_->is_open()) {
+        return user_lib_->unresolved().empty();
+    }
+    diagnostics::global().report({DIAG_ERROR, "unresolved", "", 0, 0}, \
+                                 [&](std::ostream& out) {
+        out << "Unresolved functions in user library " << \
+               user_function_path_ << " for ISA file: " << isa_file_path;
+        for (const std::string& name : user_lib_->unresolved()) {
+            out << "\n\t" << name << " at line";
+            for (size_t line_num : unresolved_lines_.at(name)) {
+                out << " " << line_num;
+            }
+        }
+    });
+    return false;
+}
 
-std::string isa::strip_and_lower(std::string& input) {
+std::string isa::strip_and_lower(const std::string& input) const {
     std::string result;
     // Copy only non-whitespace characters to result
     std::copy_if(input.begin(), input.end(), std::back_inserter(result), [](char c) {
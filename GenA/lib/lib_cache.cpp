@@ -0,0 +1,250 @@
+// lib_cache.cpp
+// C++ file for the lib_cache class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "lib_cache.hpp"
+#include "diagnostics.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <system_error>
+#include <unordered_set>
+#include <cstdio>
+
+// Constants.
+const std::string USER_LIB_COMPILER = "g++";
+const std::string USER_LIB_FLAGS = "-shared -fPIC";
+// The directory holding gena_abi.h, set by the build.
+#ifndef GENA_INCLUDE_DIR
+#define GENA_INCLUDE_DIR "include"
+#endif
+const std::string ABI_HEADER = "gena_abi.h";
+const std::string INCLUDE_DIRECTIVE = "#include";
+const std::string COMPILER_VERSION_FLAG = "--version";
+const size_t VERSION_READ_SIZE = 256;
+const std::string CACHE_ENV = "GENA_CACHE_DIR";
+const std::string CACHE_SUBDIR = "gena";
+const std::string FALLBACK_CACHE_DIR = ".gena_cache";
+const std::string LIB_EXTENSION = ".so";
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+// Constructor.
+lib_cache::lib_cache(std::string cache_dir, bool rebuild) : \
+                     cache_dir_(cache_dir), rebuild_(rebuild) {
+    if (cache_dir_.empty()) {
+        cache_dir_ = default_cache_dir();
+    }
+}
+
+// Destructor
+lib_cache::~lib_cache() {};
+
+// Public functions.
+std::string lib_cache::shared_lib(const std::string& source_file) {
+    std::ifstream source(source_file, std::ios::binary);
+    std::ostringstream contents;
+    std::error_code error;
+
+    // Display error message if the source can not be read.
+    if (!source) {
+        diagnostics::global().report({DIAG_ERROR, "lib-source", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Can not open the source file: " << source_file;
+        });
+        return LIB_CACHE_INVALID;
+    }
+    contents << source.rdbuf();
+
+    // The key covers everything that changes the compiled library. Libraries
+    // may include the ABI header in any way, so it is always hashed.
+    std::filesystem::path include_dir(GENA_INCLUDE_DIR);
+    std::ifstream abi_header(include_dir / ABI_HEADER, std::ios::binary);
+    std::ostringstream abi_contents;
+    std::unordered_set<std::string> seen;
+    abi_contents << abi_header.rdbuf();
+    uint64_t key = hash(FNV_OFFSET, compiler_identity());
+    key = hash(key, USER_LIB_FLAGS);
+    key = hash(key, abi_contents.str());
+    key = hash(key, contents.str());
+    key = hash_includes(key, source_file, contents.str(), seen);
+    std::ostringstream lib_name;
+    lib_name << std::filesystem::path(source_file).stem().string() << "-" \
+             << std::hex << std::setw(16) << std::setfill('0') << key \
+             << LIB_EXTENSION;
+    std::filesystem::path lib_path = \
+    std::filesystem::path(cache_dir_) / lib_name.str();
+
+    if (!rebuild_ && std::filesystem::exists(lib_path, error)) {
+        diagnostics::global().report({DIAG_INFO, "lib-cached", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Using cached user library " << lib_path.string();
+        });
+        return lib_path.string();
+    }
+
+    std::filesystem::create_directories(cache_dir_, error);
+    if (error) {
+        diagnostics::global().report({DIAG_ERROR, "lib-cache-dir", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Can not create cache directory: " << cache_dir_;
+        });
+        return LIB_CACHE_INVALID;
+    }
+    // Compile to a temporary file first and move it into place so concurrent
+    // runs never load a partially written library.
+    std::string temp_path = lib_path.string() + "." + \
+                            std::to_string(getpid()) + ".tmp";
+    std::string command = USER_LIB_COMPILER + " " + USER_LIB_FLAGS + " -I" + \
+                          include_dir.string() + " -o " + temp_path + " " + \
+                          source_file;
+    // The compiler writes its own errors, so ours are written before it runs.
+    diagnostics::global().flush();
+    if (system(command.c_str()) != 0) {
+        diagnostics::global().report({DIAG_ERROR, "lib-compile", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Can not compile the source file: " << source_file;
+        });
+        std::filesystem::remove(temp_path, error);
+        return LIB_CACHE_INVALID;
+    }
+    std::filesystem::rename(temp_path, lib_path, error);
+    if (error) {
+        diagnostics::global().report({DIAG_ERROR, "lib-write", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Can not write cached user library: " << \
+               lib_path.string();
+        });
+        std::filesystem::remove(temp_path, error);
+        return LIB_CACHE_INVALID;
+    }
+    diagnostics::global().report({DIAG_INFO, "lib-compiled", "", 0, 0}, \
+                                 [&](std::ostream& out) {
+        out << "Compiled user library " << lib_path.string();
+    });
+    return lib_path.string();
+}
+
+// Accessors
+std::string lib_cache::cache_dir(void) const {
+    return cache_dir_;
+}
+
+// Helper functions.
+std::string lib_cache::default_cache_dir(void) {
+    const char* dir = getenv(CACHE_ENV.c_str());
+    if ((dir != NULL) && (*dir != '\0')) {
+        return dir;
+    }
+    dir = getenv("XDG_CACHE_HOME");
+    if ((dir != NULL) && (*dir != '\0')) {
+        return (std::filesystem::path(dir) / CACHE_SUBDIR).string();
+    }
+    dir = getenv("HOME");
+    if ((dir != NULL) && (*dir != '\0')) {
+        return (std::filesystem::path(dir) / ".cache" / CACHE_SUBDIR).string();
+    }
+    return FALLBACK_CACHE_DIR;
+}
+
+uint64_t lib_cache::hash_includes(uint64_t seed, \
+                                  const std::filesystem::path& path, \
+                                  const std::string& contents, \
+                                  std::unordered_set<std::string>& seen) {
+    std::istringstream lines(contents);
+    std::string line;
+
+    while (std::getline(lines, line)) {
+        size_t start = line.find_first_not_of(" \t");
+        if ((start == std::string::npos) || \
+            (line.compare(start, INCLUDE_DIRECTIVE.size(), \
+                          INCLUDE_DIRECTIVE) != 0)) {
+            continue;
+        }
+        size_t open = line.find('"', start + INCLUDE_DIRECTIVE.size());
+        size_t close = (open == std::string::npos) ? open : \
+                       line.find('"', open + 1);
+        if (close == std::string::npos) {
+            continue;
+        }
+        // Quoted includes are searched for next to the including file and
+        // then in the include directory, as the compiler does.
+        std::string name = line.substr(open + 1, close - open - 1);
+        std::error_code error;
+        std::filesystem::path found = path.parent_path() / name;
+        if (!std::filesystem::is_regular_file(found, error)) {
+            found = std::filesystem::path(GENA_INCLUDE_DIR) / name;
+        }
+        std::string canonical = \
+            std::filesystem::weakly_canonical(found, error).string();
+        if (!seen.insert(canonical).second) {
+            continue;
+        }
+        // A missing header fails to compile, its name is enough.
+        std::ifstream header(found, std::ios::binary);
+        std::ostringstream header_contents;
+        seed = hash(seed, name);
+        if (header) {
+            header_contents << header.rdbuf();
+            seed = hash(seed, header_contents.str());
+            seed = hash_includes(seed, found, header_contents.str(), seen);
+        }
+    }
+    return seed;
+}
+
+const std::string& lib_cache::compiler_identity(void) {
+    static const std::string identity = [] {
+        std::string found;
+        const char* path = getenv("PATH");
+        std::istringstream dirs((path != NULL) ? path : "");
+        std::string dir;
+        std::error_code error;
+        // The first compiler on the path with its links resolved.
+        while (std::getline(dirs, dir, ':')) {
+            std::filesystem::path candidate = \
+                std::filesystem::path(dir.empty() ? "." : dir) / \
+                USER_LIB_COMPILER;
+            if (access(candidate.c_str(), X_OK) == 0) {
+                found = std::filesystem::canonical(candidate, error).string();
+                break;
+            }
+        }
+        found += "\n";
+        std::string command = USER_LIB_COMPILER + " " + \
+                              COMPILER_VERSION_FLAG + " 2>/dev/null";
+        FILE* version = popen(command.c_str(), "r");
+        if (version != NULL) {
+            char buffer[VERSION_READ_SIZE];
+            size_t len;
+            while ((len = fread(buffer, 1, sizeof(buffer), version)) > 0) {
+                found.append(buffer, len);
+            }
+            pclose(version);
+        }
+        return found;
+    }();
+    return identity;
+}
+
+uint64_t lib_cache::hash(uint64_t seed, const std::string& data) {
+    // FNV-1a over the data followed by its length so that adjacent fields can
+    // not run together.
+    for (unsigned char c : data) {
+        seed ^= c;
+        seed *= FNV_PRIME;
+    }
+    for (size_t len = data.size(), i = 0; i < sizeof(len); i++) {
+        seed ^= (len >> (i * 8)) & 0xFF;
+        seed *= FNV_PRIME;
+    }
+    return seed;
+}
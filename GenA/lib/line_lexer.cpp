@@ -0,0 +1,117 @@
+// line_lexer.cpp
+// C++ file for the line_lexer class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "line_lexer.hpp"
+#include <stdlib.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstring>
+#include <cctype>
+
+// Constructor.
+line_lexer::line_lexer() : num_elements_(0) {}
+
+line_lexer::line_lexer(const std::vector<std::string>& style) : \
+                       num_elements_(0) {
+    for (const std::string& element : style) {
+        if (num_elements_ == NUM_ELEMENTS) {
+            break;
+        }
+        // The delimiter is the last character of the element, the element
+        // name is everything before it.
+        std::string name = element.substr(0, element.size() - 1);
+        for (size_t kind = 0; kind < NUM_ELEMENTS; kind++) {
+            if (STYLE_ELEMENTS.at(kind) == name) {
+                order_[num_elements_] = static_cast<element_kind>(kind);
+                delims_[num_elements_] = element.back();
+                num_elements_++;
+            }
+        }
+    }
+}
+
+// Destructor
+line_lexer::~line_lexer() {};
+
+// Public functions.
+bool line_lexer::lex(char* line, size_t len, lexed_line& out) const {
+    std::string_view* elements[NUM_ELEMENTS] = {&out.label, &out.op_name, \
+                                                &out.operand};
+    char* slices[NUM_ELEMENTS][2] = {{NULL, NULL}, {NULL, NULL}, \
+                                     {NULL, NULL}};
+    // The next position of each delimiter at or after start, len if there is
+    // none.
+    size_t next[NUM_ELEMENTS];
+    size_t start = 0;
+
+    out = lexed_line();
+    while ((start < len) && (line[start] == ' ')) {
+        start++;
+    }
+    for (size_t i = 0; i < num_elements_; i++) {
+        next[i] = find(line, start, len, delims_[i]);
+    }
+
+    for (size_t i = 0; (i < num_elements_) && (start < len); i++) {
+        // Delimiters are only searched for again once the start has moved
+        // past them, so the line is scanned about once per delimiter.
+        for (size_t j = i; j < num_elements_; j++) {
+            if (next[j] < start) {
+                next[j] = find(line, start, len, delims_[j]);
+            }
+        }
+        // An element is only present if its delimiter comes before that of
+        // every element after it, and any element may end with the line.
+        size_t cutoff = std::string::npos;
+        for (size_t j = i + 1; j < num_elements_; j++) {
+            if (next[j] < len) {
+                cutoff = std::min(cutoff, next[j]);
+            }
+        }
+        if (next[i] < cutoff) {
+            slices[order_[i]][0] = line + start;
+            slices[order_[i]][1] = line + next[i];
+            start = std::min(next[i] + 1, len);
+            while ((start < len) && (line[start] == ' ')) {
+                start++;
+            }
+        }
+    }
+
+    bool found = false;
+    for (size_t kind = 0; kind < NUM_ELEMENTS; kind++) {
+        if (slices[kind][0] != NULL) {
+            *elements[kind] = normalize(slices[kind][0], slices[kind][1]);
+            found = found || !elements[kind]->empty();
+        }
+    }
+    return found;
+}
+
+// Helper functions.
+size_t line_lexer::find(const char* line, size_t start, size_t len, \
+                        char delim) {
+    const void* found = std::memchr(line + start, delim, len - start);
+    return (found == NULL) ? len : static_cast<const char*>(found) - line;
+}
+
+std::string_view line_lexer::normalize(char* begin, char* end) {
+    char* write = begin;
+    for (char* read = begin; read != end; ++read) {
+        unsigned char c = *read;
+        // Only characters that change are written, so the pages of a mapped
+        // line that is already normalized are not copied.
+        if (!std::isspace(c)) {
+            char lower = std::tolower(c);
+            if (*write != lower) {
+                *write = lower;
+            }
+            ++write;
+        }
+    }
+    return std::string_view(begin, write - begin);
+}
@@ -0,0 +1,81 @@
+// listing_writer.cpp
+// C++ file for the listing_writer class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "listing_writer.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <ostream>
+
+// Constants.
+// The buffer is written once it holds this many bytes.
+const size_t LISTING_BUFFER_SIZE = 1 << 20;
+// Addresses and values are padded to this many hex digits.
+const size_t LISTING_HEX_WIDTH = 5;
+const size_t HEX_DIGIT_BITS = 4;
+const size_t MAX_HEX_DIGITS = sizeof(size_t) * 2;
+const char LISTING_HEX_DIGITS[] = "0123456789abcdef";
+const std::string_view LISTING_TEXT_PREFIX = "\t\t\t\t;";
+
+// Constructor.
+listing_writer::listing_writer(std::ostream& file) : file_(file) {
+    buffer_.reserve(LISTING_BUFFER_SIZE + LISTING_BUFFER_SIZE / 2);
+}
+
+// Destructor
+listing_writer::~listing_writer() {};
+
+// Public functions.
+void listing_writer::add_code(size_t word_address, size_t value, \
+                              std::string_view text) {
+    append_hex(word_address);
+    buffer_ += ' ';
+    append_hex(value);
+    buffer_ += "\t;";
+    buffer_ += text;
+    buffer_ += '\n';
+    write_full();
+}
+
+void listing_writer::add_text(std::string_view text) {
+    buffer_ += LISTING_TEXT_PREFIX;
+    buffer_ += text;
+    buffer_ += '\n';
+    write_full();
+}
+
+bool listing_writer::finish(void) {
+    file_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+    file_.flush();
+    return static_cast<bool>(file_);
+}
+
+// Helper functions.
+void listing_writer::append_hex(size_t value) {
+    char digits[MAX_HEX_DIGITS];
+    size_t num_digits = 0;
+
+    // Digits are found from the least significant up, then padded.
+    do {
+        digits[num_digits++] = LISTING_HEX_DIGITS[value & 0xF];
+        value >>= HEX_DIGIT_BITS;
+    } while (value != 0);
+    if (num_digits < LISTING_HEX_WIDTH) {
+        buffer_.append(LISTING_HEX_WIDTH - num_digits, '0');
+    }
+    while (num_digits > 0) {
+        buffer_ += digits[--num_digits];
+    }
+}
+
+void listing_writer::write_full(void) {
+    if (buffer_.size() >= LISTING_BUFFER_SIZE) {
+        file_.write(buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+}
@@ -0,0 +1,150 @@
+// mnemonic_table.cpp
+// C++ file for the mnemonic_table class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "mnemonic_table.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+
+// Constants.
+const size_t NAMES_PER_BUCKET = 2;
+const uint32_t MAX_DISPLACEMENT = 1 << 16;
+const uint32_t FNV32_OFFSET = 2166136261U;
+const uint32_t FNV32_PRIME = 16777619U;
+const uint32_t SEED_MIX = 0x9E3779B9U;
+
+// Constructor.
+mnemonic_table::mnemonic_table() {}
+
+// Destructor
+mnemonic_table::~mnemonic_table() {};
+
+// Public functions.
+void mnemonic_table::build(const std::vector<std::string>& names) {
+    std::vector<std::pair<uint32_t, uint32_t>> name_slices;
+    size_t num_buckets;
+    size_t num_slots;
+    bool built;
+
+    slots_.clear();
+    displacements_.clear();
+    names_.clear();
+    if (names.empty()) {
+        return;
+    }
+    for (const std::string& name : names) {
+        name_slices.push_back({names_.size(), name.size()});
+        for (unsigned char c : name) {
+            names_ += std::tolower(c);
+        }
+    }
+
+    num_buckets = (names.size() + NAMES_PER_BUCKET - 1) / NAMES_PER_BUCKET;
+    num_slots = 1;
+    while (num_slots < names.size() + names.size() / 4) {
+        num_slots *= 2;
+    }
+
+    // Group the names by bucket.
+    std::vector<std::vector<size_t>> buckets(num_buckets);
+    for (size_t i = 0; i < names.size(); i++) {
+        std::string_view name(names_.data() + name_slices.at(i).first, \
+                              name_slices.at(i).second);
+        buckets.at(hash(name, 0) % num_buckets).push_back(i);
+    }
+    // Place the largest buckets first while the table is emptiest.
+    std::vector<size_t> order(num_buckets);
+    for (size_t b = 0; b < num_buckets; b++) {
+        order.at(b) = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return buckets.at(a).size() > buckets.at(b).size();
+    });
+
+    // Try displacements for every bucket until all of its names land in free
+    // slots, doubling the table if some bucket can not be placed.
+    built = false;
+    while (!built) {
+        slots_.assign(num_slots, {0, 0, MNEMONIC_NONE});
+        displacements_.assign(num_buckets, 0);
+        built = true;
+        for (size_t b : order) {
+            const std::vector<size_t>& bucket = buckets.at(b);
+            std::vector<size_t> taken;
+            uint32_t d;
+            for (d = 0; d < MAX_DISPLACEMENT; d++) {
+                taken.clear();
+                for (size_t i : bucket) {
+                    std::string_view name(names_.data() + \
+                                          name_slices.at(i).first, \
+                                          name_slices.at(i).second);
+                    size_t s = hash(name, d + 1) & (num_slots - 1);
+                    if ((slots_.at(s).index != MNEMONIC_NONE) || \
+                        (std::find(taken.begin(), taken.end(), s) != \
+                         taken.end())) {
+                        break;
+                    }
+                    taken.push_back(s);
+                }
+                if (taken.size() == bucket.size()) {
+                    break;
+                }
+            }
+            if (d == MAX_DISPLACEMENT) {
+                built = false;
+                num_slots *= 2;
+                break;
+            }
+            displacements_.at(b) = d;
+            for (size_t j = 0; j < bucket.size(); j++) {
+                size_t i = bucket.at(j);
+                slots_.at(taken.at(j)) = {name_slices.at(i).first, \
+                                          name_slices.at(i).second, i};
+            }
+        }
+    }
+}
+
+size_t mnemonic_table::find(std::string_view name) const {
+    if (slots_.empty()) {
+        return MNEMONIC_NONE;
+    }
+    uint32_t d = displacements_[hash(name, 0) % displacements_.size()];
+    const slot& s = slots_[hash(name, d + 1) & (slots_.size() - 1)];
+    // The slot holds the only name that can match, compare without case.
+    if ((s.index == MNEMONIC_NONE) || (s.name_len != name.size())) {
+        return MNEMONIC_NONE;
+    }
+    const char* stored = names_.data() + s.name_offset;
+    for (size_t i = 0; i < name.size(); i++) {
+        if (std::tolower(static_cast<unsigned char>(name[i])) != \
+            static_cast<unsigned char>(stored[i])) {
+            return MNEMONIC_NONE;
+        }
+    }
+    return s.index;
+}
+
+// Helper functions.
+uint32_t mnemonic_table::hash(std::string_view name, uint32_t seed) {
+    // FNV-1a of the lowercase name with the seed mixed in, then finalized so
+    // that nearby seeds give unrelated slots.
+    uint32_t h = FNV32_OFFSET ^ (seed * SEED_MIX);
+    for (unsigned char c : name) {
+        h ^= std::tolower(c);
+        h *= FNV32_PRIME;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6BU;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35U;
+    h ^= h >> 16;
+    return h;
+}
@@ -0,0 +1,134 @@
+// op_matcher.cpp
+// C++ file for the op_matcher class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "op_matcher.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cctype>
+
+// Constructor.
+op_matcher::op_matcher(const std::vector<std::string>& operand_template) : \
+                       lead_(0), valid_(true) {
+    size_t num_args = 0;
+    for (const std::string& sym : operand_template) {
+        if (sym == PC) {
+            steps_.push_back({STEP_PC, 0, 0});
+            num_args++;
+        }
+        else if (sym == VALUE) {
+            // Adjacent values can not be told apart so they are one value.
+            if (steps_.empty() || (steps_.back().kind != STEP_VALUE)) {
+                steps_.push_back({STEP_VALUE, 0, 0});
+                num_args++;
+            }
+        }
+        else if (sym.find(SYMBOL) == 0) {
+            // Symbols are stored lowercase without white space, the same as
+            // the operands they are matched against.
+            uint32_t offset = symbols_.size();
+            for (size_t i = SYMBOL.length(); i < sym.size(); i++) {
+                unsigned char c = sym.at(i);
+                if (!std::isspace(c)) {
+                    symbols_ += std::tolower(c);
+                }
+            }
+            uint32_t len = symbols_.size() - offset;
+            if (len == 0) {
+                continue;
+            }
+            // Adjacent symbols are one longer symbol.
+            if (!steps_.empty() && (steps_.back().kind == STEP_SYMBOL)) {
+                steps_.back().len += len;
+            }
+            else {
+                steps_.push_back({STEP_SYMBOL, offset, len});
+            }
+        }
+        else {
+            valid_ = false;
+        }
+    }
+    if (num_args > OP_MAX_ARGS) {
+        valid_ = false;
+    }
+    if (!steps_.empty() && (steps_.front().kind == STEP_SYMBOL)) {
+        lead_ = symbols_.at(steps_.front().offset);
+    }
+}
+
+// Destructor
+op_matcher::~op_matcher() {};
+
+// Public functions.
+size_t op_matcher::match(std::string_view op, op_arg* args) const {
+    size_t num_args = 0;
+    size_t pos = 0;
+    // The argument of the value whose end has not been found yet.
+    size_t pending = OP_NO_MATCH;
+
+    for (const step& s : steps_) {
+        switch (s.kind) {
+            case STEP_SYMBOL: {
+                std::string_view sym(symbols_.data() + s.offset, s.len);
+                // A symbol after a value ends the value at its first
+                // occurrence, the value may not be empty.
+                if (pending != OP_NO_MATCH) {
+                    size_t found = op.find(sym, pos);
+                    if ((found == std::string_view::npos) || (found == pos)) {
+                        return OP_NO_MATCH;
+                    }
+                    args[pending].len = found - pos;
+                    pending = OP_NO_MATCH;
+                    pos = found + sym.size();
+                }
+                // Otherwise the symbol must be next in the operand.
+                else if (op.compare(pos, sym.size(), sym) == 0) {
+                    pos += sym.size();
+                }
+                else {
+                    return OP_NO_MATCH;
+                }
+                break;
+            }
+            case STEP_VALUE:
+                args[num_args] = {pos, 0, false, SYMBOL_NONE};
+                pending = num_args;
+                num_args++;
+                break;
+            case STEP_PC:
+                args[num_args] = {0, 0, true, SYMBOL_NONE};
+                num_args++;
+                break;
+        }
+    }
+    // A value at the end of the template takes the rest of the operand.
+    if (pending != OP_NO_MATCH) {
+        if (pos == op.size()) {
+            return OP_NO_MATCH;
+        }
+        args[pending].len = op.size() - pos;
+        pos = op.size();
+    }
+    // The whole operand must be used by the template.
+    if (pos != op.size()) {
+        return OP_NO_MATCH;
+    }
+    return num_args;
+}
+
+// Accessors
+char op_matcher::lead(void) const {
+    return lead_;
+}
+size_t op_matcher::num_symbol_chars(void) const {
+    return symbols_.size();
+}
+bool op_matcher::valid(void) const {
+    return valid_;
+}
@@ -0,0 +1,169 @@
+// segment_image.cpp
+// C++ file for the segment_image class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "segment_image.hpp"
+#include "asm_line.hpp"
+#include "code_macro.hpp"
+#include "op_matcher.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <iterator>
+
+// Constructor.
+segment_image::segment_image() : limit_(std::string::npos), \
+                                 floor_(0) {}
+
+// Destructor
+segment_image::~segment_image() {};
+
+// Public functions.
+bool segment_image::place(size_t address, const asm_line& line, \
+                          size_t num_bits) {
+    // A line that does not continue the current run starts a new one. Only the
+    // newest run can grow so the runs around it bound where it may grow to.
+    if (runs_.empty() || (address != runs_.back().end)) {
+        if (!runs_.empty() && (runs_.back().end != runs_.back().start)) {
+            cover(runs_.back().start, runs_.back().end);
+        }
+        run_bounds(address, floor_, limit_);
+        run_index_.insert({address, runs_.size()});
+        runs_.push_back({address, address, lines_.size(), 0, \
+                         std::string::npos});
+    }
+
+    run& current = runs_.back();
+    bool fits = (num_bits == 0) || \
+                ((current.end >= floor_) && \
+                 (current.end + num_bits <= limit_));
+    addresses_.push_back(address);
+    sizes_.push_back(num_bits);
+    macros_.push_back(line.macro());
+    operands_.push_back(line.operand().data());
+    arguments_.push_back(line.arguments());
+    num_arguments_.push_back(line.num_arguments());
+    lines_.push_back(&line);
+    current.end += num_bits;
+    current.count++;
+    return fits;
+}
+
+void segment_image::resize(size_t line, const code_macro* macro, \
+                           size_t num_bits) {
+    macros_.at(line) = macro;
+    sizes_.at(line) = num_bits;
+    // Runs are in line order, the run holding the line is the last one
+    // starting at or before it.
+    auto it = std::upper_bound(runs_.begin(), runs_.end(), line, \
+                               [](size_t index, const run& r) {
+        return index < r.first;
+    });
+    run& r = *(it - 1);
+    if (r.resized == std::string::npos) {
+        resized_runs_.push_back(it - 1 - runs_.begin());
+    }
+    r.resized = std::min(r.resized, line);
+}
+
+void segment_image::reflow(void) {
+    for (size_t index : resized_runs_) {
+        run& r = runs_.at(index);
+        size_t address = addresses_.at(r.resized);
+        for (size_t i = r.resized; i < r.first + r.count; i++) {
+            addresses_[i] = address;
+            address += sizes_[i];
+        }
+        r.end = address;
+        r.resized = std::string::npos;
+    }
+    resized_runs_.clear();
+}
+
+void segment_image::order_by_address(void) {
+    std::vector<size_t> order;
+    bool ordered = true;
+    order.reserve(lines_.size());
+    // Runs are visited by start address and lines inside a run are already
+    // in address order. The runs are moved with their lines.
+    for (const auto& entry : run_index_) {
+        run& r = runs_.at(entry.second);
+        ordered = ordered && (r.first == order.size());
+        size_t first = order.size();
+        for (size_t i = r.first; i < r.first + r.count; i++) {
+            order.push_back(i);
+        }
+        r.first = first;
+    }
+    // Most programs are one run or are placed in address order already.
+    if (ordered) {
+        return;
+    }
+    permute(addresses_, order);
+    permute(sizes_, order);
+    permute(macros_, order);
+    permute(operands_, order);
+    permute(arguments_, order);
+    permute(num_arguments_, order);
+    permute(lines_, order);
+}
+
+// Accessors
+const std::vector<size_t>& segment_image::addresses(void) const {
+    return addresses_;
+}
+const std::vector<uint32_t>& segment_image::sizes(void) const {
+    return sizes_;
+}
+const std::vector<const code_macro*>& segment_image::macros(void) const {
+    return macros_;
+}
+const std::vector<const char*>& segment_image::operands(void) const {
+    return operands_;
+}
+const std::vector<const op_arg*>& segment_image::arguments(void) const {
+    return arguments_;
+}
+const std::vector<uint8_t>& segment_image::num_arguments(void) const {
+    return num_arguments_;
+}
+const std::vector<const asm_line*>& segment_image::lines(void) const {
+    return lines_;
+}
+size_t segment_image::size(void) const {
+    return lines_.size();
+}
+
+// Helper functions.
+void segment_image::run_bounds(size_t address, size_t& floor, \
+                               size_t& limit) const {
+    auto next = covered_.upper_bound(address);
+
+    // Runs that overlap are still kept, so the covered range holding the
+    // address may span several runs. The run may grow up to the next range.
+    floor = address;
+    if ((next != covered_.begin()) && (std::prev(next)->second > address)) {
+        floor = std::prev(next)->second;
+    }
+    limit = (next != covered_.end()) ? next->first : std::string::npos;
+}
+
+void segment_image::cover(size_t start, size_t end) {
+    auto it = covered_.upper_bound(start);
+
+    // Ranges that overlap or touch the run are merged into it.
+    if ((it != covered_.begin()) && (std::prev(it)->second >= start)) {
+        --it;
+        start = it->first;
+    }
+    while ((it != covered_.end()) && (it->first <= end)) {
+        end = std::max(end, it->second);
+        it = covered_.erase(it);
+    }
+    covered_.insert({start, end});
+}
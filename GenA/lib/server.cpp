@@ -0,0 +1,856 @@
+// server.cpp
+// C++ file for the server class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "server.hpp"
+#include "lib_cache.hpp"
+#include "isa.hpp"
+#include "source_cache.hpp"
+#include "chunk_runner.hpp"
+#include "diagnostics.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <time.h>
+#include <sys/inotify.h>
+
+// Constants.
+const int SERVER_BACKLOG = 64;
+// The standard output and error passed by the client.
+const size_t NUM_PASSED_FDS = 2;
+// How long the server waits on a client sending its job.
+const time_t REQUEST_TIMEOUT_S = 5;
+// Limits on the size of a job.
+const uint32_t MAX_JOB_STRINGS = 4096;
+const uint32_t MAX_JOB_STRING_LEN = 1 << 20;
+// The exit status of a job that ended on a signal is this plus the signal.
+const int SIGNAL_STATUS = 128;
+const size_t REPORT_READ_SIZE = 4096;
+// The events that change a watched file, how long the files must be quiet
+// after a change before the job runs again, and the size of event reads.
+const uint32_t WATCH_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | \
+                              IN_CREATE | IN_DELETE;
+const int WATCH_SETTLE_MS = 100;
+const size_t WATCH_READ_SIZE = 4096;
+const int64_t NS_PER_S = 1000000000;
+
+// Set by signals that stop the server.
+static volatile sig_atomic_t stopping = 0;
+
+static void stop_handler(int) {
+    stopping = 1;
+}
+
+// Constructor.
+server::server(std::string socket_path, size_t jobs) : \
+               socket_path_(absolute(socket_path)), runner_(jobs), \
+               listen_fd_(-1), report_fd_(-1), copy_files_(false), \
+               warmer_stopping_(false) {
+    std::error_code error;
+    cwd_ = std::filesystem::current_path(error).string();
+}
+
+// Destructor
+server::~server() {
+    for (job& running : jobs_) {
+        close(running.client);
+        close(running.report);
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+    }
+}
+
+// Public functions.
+bool server::serve(const std::function<int(int, char**)>& run_job) {
+    struct sockaddr_un address;
+
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path_.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: Socket path too long: " << socket_path_ << \
+                     std::endl;
+        return false;
+    }
+    std::strcpy(address.sun_path, socket_path_.c_str());
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "Error: Cannot create socket: " << std::strerror(errno) \
+                  << std::endl;
+        return false;
+    }
+    // A socket left by a server that is no longer running is replaced, one
+    // that still accepts connections is not.
+    if (connect(listen_fd_, reinterpret_cast<struct sockaddr*>(&address), \
+                sizeof(address)) == 0) {
+        std::cerr << "Error: A server is already running on " << \
+                     socket_path_ << std::endl;
+        return false;
+    }
+    close(listen_fd_);
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_path_.c_str());
+    // Jobs run as the server's user, so the socket is created usable by that
+    // user only.
+    mode_t old_mask = umask(S_IRWXG | S_IRWXO);
+    bool bound = (listen_fd_ >= 0) && \
+                 (bind(listen_fd_, \
+                       reinterpret_cast<struct sockaddr*>(&address), \
+                       sizeof(address)) == 0);
+    umask(old_mask);
+    if (!bound || (listen(listen_fd_, SERVER_BACKLOG) != 0)) {
+        std::cerr << "Error: Cannot serve on " << socket_path_ << ": " << \
+                     std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Files stay loaded between jobs while clients edit them, so they are
+    // copied rather than mapped.
+    copy_files_ = true;
+    // Interrupting the server stops it after its running jobs finish.
+    handle_stop_signals();
+    // The worker blocks the signals that stop the server so they always
+    // interrupt the poll for jobs.
+    sigset_t stop_signals;
+    sigset_t old_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &old_signals);
+    warmer_stopping_ = false;
+    warmer_ = std::thread(&server::run_warmer, this);
+    pthread_sigmask(SIG_SETMASK, &old_signals, NULL);
+    std::clog << "Serving on " << socket_path_ << std::endl;
+
+    while (!stopping) {
+        std::vector<struct pollfd> fds;
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (const job& running : jobs_) {
+            fds.push_back({running.report, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Error: Cannot wait for jobs: " << \
+                         std::strerror(errno) << std::endl;
+            break;
+        }
+        // Reports are read before new jobs are started so each job still
+        // lines up with its poll entry. A job is done when its child closes
+        // the report pipe, which it does when it exits.
+        for (size_t i = jobs_.size(); i > 0; i--) {
+            if (fds.at(i).revents == 0) {
+                continue;
+            }
+            char buffer[REPORT_READ_SIZE];
+            ssize_t len = read(jobs_.at(i - 1).report, buffer, \
+                               sizeof(buffer));
+            if (len > 0) {
+                jobs_.at(i - 1).report_text.append(buffer, len);
+            }
+            else if ((len == 0) || (errno != EINTR)) {
+                finish_job(jobs_.at(i - 1));
+                jobs_.erase(jobs_.begin() + (i - 1));
+            }
+        }
+        if (fds.front().revents & POLLIN) {
+            int client = accept(listen_fd_, NULL, NULL);
+            if (client >= 0) {
+                start_job(client, run_job);
+            }
+        }
+    }
+
+    // Let the running jobs finish before the server stops.
+    for (job& running : jobs_) {
+        char buffer[REPORT_READ_SIZE];
+        while (read(running.report, buffer, sizeof(buffer)) > 0) {}
+        running.report_text.clear();
+        finish_job(running);
+    }
+    jobs_.clear();
+    // The worker finishes what it is loading, anything waiting is dropped.
+    {
+        std::lock_guard<std::mutex> lock(warm_mutex_);
+        warmer_stopping_ = true;
+        pending_.clear();
+    }
+    warm_ready_.notify_one();
+    warmer_.join();
+    close(listen_fd_);
+    listen_fd_ = -1;
+    unlink(socket_path_.c_str());
+    std::clog << "Server stopped." << std::endl;
+    return true;
+}
+
+bool server::watch(std::vector<std::string> args, \
+                   const std::vector<std::string>& paths, \
+                   const std::function<int(int, char**)>& run_job) {
+    std::vector<std::string> watched;
+    watch_set watches;
+    bool changed = false;
+    int notify_fd = inotify_init1(IN_CLOEXEC);
+
+    if (notify_fd < 0) {
+        std::cerr << "Error: Cannot watch files: " << std::strerror(errno) \
+                  << std::endl;
+        return false;
+    }
+    // Interrupting the watch stops it after the running job finishes.
+    handle_stop_signals();
+    for (const std::string& path : paths) {
+        watched.push_back(absolute(path));
+    }
+    // The files are watched before the first build and stay watched while
+    // the job runs, so changes saved during a build are not lost.
+    if (!update_watches(notify_fd, watched, watches, \
+                        std::numeric_limits<int64_t>::max(), changed)) {
+        close(notify_fd);
+        return false;
+    }
+
+    while (!stopping) {
+        int pipe_fds[2];
+        std::string report_text;
+        // File times are set from the coarse clock, so it is used to tell
+        // whether a file was modified after the job started.
+        struct timespec started;
+        clock_gettime(CLOCK_REALTIME_COARSE, &started);
+        int64_t since_ns = static_cast<int64_t>(started.tv_sec) * NS_PER_S + \
+                           started.tv_nsec;
+        if (pipe(pipe_fds) != 0) {
+            std::cerr << "Error: Cannot run job: " << std::strerror(errno) \
+                      << std::endl;
+            break;
+        }
+        // Buffered output is written before forking so the child does not
+        // write it again.
+        diagnostics::global().flush();
+        std::cout.flush();
+        std::clog.flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(notify_fd);
+            close(pipe_fds[0]);
+            report_fd_ = pipe_fds[1];
+            run_child(args, run_job);
+        }
+        close(pipe_fds[1]);
+        if (pid < 0) {
+            close(pipe_fds[0]);
+            std::cerr << "Error: Cannot run job: " << std::strerror(errno) \
+                      << std::endl;
+            break;
+        }
+        // The job is done when its child closes the report pipe.
+        char buffer[REPORT_READ_SIZE];
+        ssize_t len;
+        while (((len = read(pipe_fds[0], buffer, sizeof(buffer))) > 0) || \
+               ((len < 0) && (errno == EINTR))) {
+            if (len > 0) {
+                report_text.append(buffer, len);
+            }
+        }
+        close(pipe_fds[0]);
+        while ((waitpid(pid, NULL, 0) < 0) && (errno == EINTR)) {}
+
+        // The files the job reported are watched along with its ISA, so a
+        // job that failed before reporting keeps the files watched before.
+        if (!report_text.empty()) {
+            std::istringstream report(report_text);
+            std::string isa_path;
+            std::string cache_dir;
+            std::string path;
+            warm(cwd_, report_text);
+            std::getline(report, isa_path);
+            std::getline(report, cache_dir);
+            watched.clear();
+            for (const std::string& given : paths) {
+                watched.push_back(absolute(given));
+            }
+            watched.push_back(isa_path);
+            warm_isa* entry = find(isa_path, cache_dir);
+            if (entry != NULL) {
+                watched.push_back(entry->source_path);
+            }
+            while (std::getline(report, path)) {
+                watched.push_back(absolute(path));
+            }
+        }
+        // Files the job used for the first time were not watched while it
+        // ran, so their times tell whether they changed since it started.
+        if (!update_watches(notify_fd, watched, watches, since_ns, changed)) {
+            break;
+        }
+        std::clog << "Watching for changes." << std::endl;
+        if (!wait_for_change(notify_fd, watches, changed)) {
+            break;
+        }
+        changed = false;
+    }
+    close(notify_fd);
+    std::clog << "Watch stopped." << std::endl;
+    return true;
+}
+
+warm_isa* server::find(const std::string& isa_path, \
+                       const std::string& cache_dir) {
+    std::string abs_isa = absolute(isa_path);
+    std::string abs_cache = absolute(cache_dir);
+
+    for (std::unique_ptr<warm_isa>& entry : isas_) {
+        if ((entry->isa_path == abs_isa) && (entry->cache_dir == abs_cache)) {
+            return unchanged(*entry) ? entry.get() : NULL;
+        }
+    }
+    return NULL;
+}
+
+void server::report(const std::string& isa_path, \
+                    const std::string& cache_dir, \
+                    const std::vector<std::string>& source_paths) {
+    if (report_fd_ < 0) {
+        return;
+    }
+    std::string text = absolute(isa_path) + "\n" + absolute(cache_dir) + "\n";
+    for (const std::string& path : source_paths) {
+        text += path + "\n";
+    }
+    write_all(report_fd_, text.data(), text.size());
+}
+
+bool server::request(const std::string& socket_path, \
+                     const std::vector<std::string>& args, int& status) {
+    struct sockaddr_un address;
+    std::error_code error;
+    int fd;
+
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&address), \
+                sizeof(address)) != 0) {
+        close(fd);
+        return false;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    // The standard output and error are passed with the first byte of the
+    // job, then the protocol version, working directory and arguments.
+    int passed[NUM_PASSED_FDS] = {STDOUT_FILENO, STDERR_FILENO};
+    char control[CMSG_SPACE(sizeof(passed))];
+    char tag = 'g';
+    struct iovec data = {&tag, 1};
+    struct msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    std::memset(control, 0, sizeof(control));
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    struct cmsghdr* rights = CMSG_FIRSTHDR(&message);
+    rights->cmsg_level = SOL_SOCKET;
+    rights->cmsg_type = SCM_RIGHTS;
+    rights->cmsg_len = CMSG_LEN(sizeof(passed));
+    std::memcpy(CMSG_DATA(rights), passed, sizeof(passed));
+
+    std::string cwd = std::filesystem::current_path(error).string();
+    uint32_t version = SERVER_PROTOCOL_VERSION;
+    uint32_t count = args.size();
+    bool sent = (sendmsg(fd, &message, 0) == 1) && \
+                write_all(fd, &version, sizeof(version)) && \
+                write_string(fd, cwd) && \
+                write_all(fd, &count, sizeof(count));
+    for (size_t i = 0; sent && (i < args.size()); i++) {
+        sent = write_string(fd, args.at(i));
+    }
+    int32_t result;
+    // The server closes the connection without a status if it did not run
+    // the job.
+    bool ran = sent && read_all(fd, &result, sizeof(result));
+    close(fd);
+    if (ran) {
+        status = result;
+    }
+    return ran;
+}
+
+// Helper functions.
+void server::handle_stop_signals(void) {
+    struct sigaction stop;
+
+    // Poll must be interrupted by the signals so it is not restarted.
+    std::memset(&stop, 0, sizeof(stop));
+    stop.sa_handler = stop_handler;
+    sigemptyset(&stop.sa_mask);
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+    // A client that goes away must not end the server.
+    signal(SIGPIPE, SIG_IGN);
+}
+
+void server::run_child(std::vector<std::string>& args, \
+                       const std::function<int(int, char**)>& run_job) {
+    std::vector<char*> argv;
+
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGPIPE, SIG_DFL);
+    // The job counts only its own diagnostics, not those of the server or
+    // earlier jobs.
+    diagnostics::global().reset_counts();
+    for (std::string& arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(NULL);
+    exit(run_job(args.size(), argv.data()));
+}
+
+bool server::update_watches(int notify_fd, \
+                            const std::vector<std::string>& paths, \
+                            watch_set& watched, int64_t since_ns, \
+                            bool& changed) {
+    std::unordered_map<int, std::unordered_set<std::string>> names;
+
+    for (const std::string& path : paths) {
+        std::filesystem::path file(path);
+        std::string dir = file.parent_path().string();
+        std::string name = file.filename().string();
+        auto found = watched.dirs.find(dir);
+        int wd;
+        if (found != watched.dirs.end()) {
+            wd = found->second;
+        }
+        else {
+            wd = inotify_add_watch(notify_fd, dir.c_str(), WATCH_EVENTS);
+            if (wd < 0) {
+                continue;
+            }
+            watched.dirs.insert({dir, wd});
+        }
+        auto before = watched.names.find(wd);
+        file_stamp now;
+        if (((before == watched.names.end()) || \
+             (before->second.count(name) == 0)) && \
+            source_cache::stamp(path, now) && (now.mtime_ns >= since_ns)) {
+            changed = true;
+        }
+        names[wd].insert(name);
+    }
+    // Directories without watched files are no longer watched.
+    for (auto dir = watched.dirs.begin(); dir != watched.dirs.end();) {
+        if (names.count(dir->second) == 0) {
+            inotify_rm_watch(notify_fd, dir->second);
+            dir = watched.dirs.erase(dir);
+        }
+        else {
+            dir++;
+        }
+    }
+    watched.names = std::move(names);
+    if (watched.names.empty()) {
+        std::cerr << "Error: Cannot watch files: " << std::strerror(errno) \
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool server::wait_for_change(int notify_fd, const watch_set& watched, \
+                             bool changed) {
+    // After the first change, changes are collected until the files are quiet
+    // so a save that writes several files runs the job once.
+    while (!stopping) {
+        struct pollfd fd = {notify_fd, POLLIN, 0};
+        int ready = poll(&fd, 1, changed ? WATCH_SETTLE_MS : -1);
+        if ((ready < 0) && (errno != EINTR)) {
+            std::cerr << "Error: Cannot watch files: " << \
+                         std::strerror(errno) << std::endl;
+            break;
+        }
+        if (ready == 0) {
+            break;
+        }
+        if (ready < 0) {
+            continue;
+        }
+        alignas(struct inotify_event) char buffer[WATCH_READ_SIZE];
+        ssize_t len = read(notify_fd, buffer, sizeof(buffer));
+        for (ssize_t pos = 0; pos < len;) {
+            const struct inotify_event* event = \
+                reinterpret_cast<const struct inotify_event*>(buffer + pos);
+            auto watch = watched.names.find(event->wd);
+            if ((event->len > 0) && (watch != watched.names.end()) && \
+                (watch->second.count(event->name) > 0)) {
+                changed = true;
+            }
+            pos += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return changed && !stopping;
+}
+
+void server::start_job(int client, \
+                       const std::function<int(int, char**)>& run_job) {
+    struct timeval timeout = {REQUEST_TIMEOUT_S, 0};
+    int passed[NUM_PASSED_FDS];
+    size_t num_passed = 0;
+    char control[CMSG_SPACE(sizeof(passed))];
+    char tag;
+    struct iovec data = {&tag, 1};
+    struct msghdr message;
+    struct ucred peer;
+    socklen_t peer_len = sizeof(peer);
+    job started;
+
+    // Only clients of the server's user are served, whatever the mode of
+    // the socket.
+    if ((getsockopt(client, SOL_SOCKET, SO_PEERCRED, &peer, &peer_len) != 0) \
+        || (peer.uid != geteuid())) {
+        close(client);
+        return;
+    }
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    if (recvmsg(client, &message, 0) == 1) {
+        for (struct cmsghdr* rights = CMSG_FIRSTHDR(&message); \
+             rights != NULL; rights = CMSG_NXTHDR(&message, rights)) {
+            if ((rights->cmsg_level == SOL_SOCKET) && \
+                (rights->cmsg_type == SCM_RIGHTS)) {
+                num_passed = (rights->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                std::memcpy(passed, CMSG_DATA(rights), \
+                            std::min(num_passed, NUM_PASSED_FDS) * \
+                            sizeof(int));
+            }
+        }
+    }
+    // Jobs from other versions or without both streams are not run, the
+    // client runs them itself.
+    uint32_t version = 0;
+    uint32_t count = 0;
+    std::vector<std::string> args;
+    bool valid = (num_passed == NUM_PASSED_FDS) && \
+                 read_all(client, &version, sizeof(version)) && \
+                 (version == SERVER_PROTOCOL_VERSION) && \
+                 read_string(client, started.cwd) && \
+                 read_all(client, &count, sizeof(count)) && \
+                 (count > 0) && (count <= MAX_JOB_STRINGS);
+    for (uint32_t i = 0; valid && (i < count); i++) {
+        args.emplace_back();
+        valid = read_string(client, args.back());
+    }
+    int pipe_fds[2];
+    if (!valid || (pipe(pipe_fds) != 0)) {
+        for (size_t i = 0; i < std::min(num_passed, NUM_PASSED_FDS); i++) {
+            close(passed[i]);
+        }
+        close(client);
+        return;
+    }
+
+    // Buffered output is written before forking so the child does not write
+    // it again.
+    diagnostics::global().flush();
+    std::cout.flush();
+    std::clog.flush();
+    {
+        std::lock_guard<std::mutex> lock(warm_mutex_);
+        started.pid = fork();
+    }
+    if (started.pid == 0) {
+        // The child keeps only the streams of its client and its report pipe.
+        close(listen_fd_);
+        for (job& running : jobs_) {
+            close(running.client);
+            close(running.report);
+        }
+        jobs_.clear();
+        close(client);
+        close(pipe_fds[0]);
+        report_fd_ = pipe_fds[1];
+        dup2(passed[0], STDOUT_FILENO);
+        dup2(passed[1], STDERR_FILENO);
+        close(passed[0]);
+        close(passed[1]);
+        if (chdir(started.cwd.c_str()) != 0) {
+            std::cerr << "Error: Cannot change to directory " << \
+                         started.cwd << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        run_child(args, run_job);
+    }
+    close(pipe_fds[1]);
+    close(passed[0]);
+    close(passed[1]);
+    if (started.pid < 0) {
+        close(pipe_fds[0]);
+        close(client);
+        return;
+    }
+    started.client = client;
+    started.report = pipe_fds[0];
+    jobs_.push_back(started);
+}
+
+void server::finish_job(job& done) {
+    int wait_status = 0;
+    int32_t status = EXIT_FAILURE;
+
+    while ((waitpid(done.pid, &wait_status, 0) < 0) && (errno == EINTR)) {}
+    if (WIFEXITED(wait_status)) {
+        status = WEXITSTATUS(wait_status);
+    }
+    else if (WIFSIGNALED(wait_status)) {
+        status = SIGNAL_STATUS + WTERMSIG(wait_status);
+    }
+    write_all(done.client, &status, sizeof(status));
+    close(done.client);
+    close(done.report);
+    if (!done.report_text.empty()) {
+        std::lock_guard<std::mutex> lock(warm_mutex_);
+        pending_.emplace_back(done.cwd, done.report_text);
+        warm_ready_.notify_one();
+    }
+}
+
+void server::run_warmer(void) {
+    std::unique_lock<std::mutex> lock(warm_mutex_);
+
+    while (true) {
+        warm_ready_.wait(lock, [&]() {
+            return warmer_stopping_ || !pending_.empty();
+        });
+        if (warmer_stopping_) {
+            return;
+        }
+        std::pair<std::string, std::string> next = \
+            std::move(pending_.front());
+        pending_.pop_front();
+        lock.unlock();
+        warm(next.first, next.second);
+        lock.lock();
+    }
+}
+
+void server::warm(const std::string& cwd, const std::string& report_text) {
+    std::istringstream report(report_text);
+    std::string isa_path;
+    std::string cache_dir;
+    std::string path;
+
+    if (!std::getline(report, isa_path) || !std::getline(report, cache_dir) \
+        || (chdir(cwd.c_str()) != 0)) {
+        return;
+    }
+    // The ISA is loaded again if it is not loaded or has changed. It may have
+    // changed since the job loaded it and an ISA with errors ends the process
+    // loading it, so it is kept only if a child loads it first and it is
+    // unchanged since.
+    std::unique_ptr<warm_isa> entry = take(absolute(isa_path), \
+                                           absolute(cache_dir));
+    if (entry == NULL) {
+        entry = std::make_unique<warm_isa>();
+        file_stamp loaded_stamp;
+        entry->isa_path = absolute(isa_path);
+        entry->cache_dir = absolute(cache_dir);
+        // Stamps are taken first so a change while loading is seen later.
+        source_cache::stamp(isa_path, entry->isa_stamp);
+        if (!loads(isa_path, cache_dir) || \
+            !source_cache::stamp(isa_path, loaded_stamp) || \
+            !(loaded_stamp == entry->isa_stamp)) {
+            if (chdir(cwd_.c_str()) != 0) {
+                std::cerr << "Error: Cannot change to directory " << cwd_ \
+                          << std::endl;
+            }
+            return;
+        }
+        // Building the ISA opens its user library, which must not be under
+        // way when a job is forked.
+        {
+            std::lock_guard<std::mutex> lock(warm_mutex_);
+            entry->cache = std::make_unique<lib_cache>(cache_dir, false);
+            entry->cpu_isa = std::make_unique<isa>(isa_path, *entry->cache);
+        }
+        entry->source_path = absolute(entry->cpu_isa->user_source_path());
+        source_cache::stamp(entry->source_path, entry->source_stamp);
+        entry->sources = std::make_unique<source_cache>(*entry->cpu_isa, \
+                                                        copy_files_);
+    }
+    while (std::getline(report, path)) {
+        entry->sources->load(path, runner_);
+    }
+    entry->sources->release_stale();
+    entry->sources->clear_parsed_paths();
+    {
+        std::lock_guard<std::mutex> lock(warm_mutex_);
+        isas_.push_back(std::move(entry));
+    }
+    if (chdir(cwd_.c_str()) != 0) {
+        std::cerr << "Error: Cannot change to directory " << cwd_ << \
+                     std::endl;
+    }
+}
+
+std::unique_ptr<warm_isa> server::take(const std::string& isa_path, \
+                                       const std::string& cache_dir) {
+    std::unique_ptr<warm_isa> entry;
+    std::lock_guard<std::mutex> lock(warm_mutex_);
+
+    for (auto loaded = isas_.begin(); loaded != isas_.end(); loaded++) {
+        if (((*loaded)->isa_path == isa_path) && \
+            ((*loaded)->cache_dir == cache_dir)) {
+            entry = std::move(*loaded);
+            isas_.erase(loaded);
+            break;
+        }
+    }
+    // An ISA that changed is freed here, since freeing it closes its user
+    // library.
+    if ((entry != NULL) && !unchanged(*entry)) {
+        entry.reset();
+    }
+    return entry;
+}
+
+bool server::loads(const std::string& isa_path, \
+                   const std::string& cache_dir) {
+    int wait_status = 0;
+
+    diagnostics::global().flush();
+    std::cout.flush();
+    std::clog.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        // The job already displayed any errors in the ISA.
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            close(null_fd);
+        }
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        lib_cache cache(cache_dir, false);
+        isa cpu_isa(isa_path, cache);
+        diagnostics::global().flush();
+        _exit(EXIT_SUCCESS);
+    }
+    if (pid < 0) {
+        return false;
+    }
+    while ((waitpid(pid, &wait_status, 0) < 0) && (errno == EINTR)) {}
+    return WIFEXITED(wait_status) && \
+           (WEXITSTATUS(wait_status) == EXIT_SUCCESS);
+}
+
+bool server::unchanged(const warm_isa& entry) {
+    file_stamp isa_now;
+    file_stamp source_now;
+
+    // The user function file is written relative to the working directory,
+    // so the same ISA file can name different files.
+    return source_cache::stamp(entry.isa_path, isa_now) && \
+           (isa_now == entry.isa_stamp) && \
+           (absolute(entry.cpu_isa->user_source_path()) == \
+            entry.source_path) && \
+           source_cache::stamp(entry.source_path, source_now) && \
+           (source_now == entry.source_stamp);
+}
+
+std::string server::absolute(const std::string& path) {
+    std::error_code error;
+    if (path.empty()) {
+        return path;
+    }
+    std::filesystem::path full = std::filesystem::absolute(path, error);
+    return error ? path : full.lexically_normal().string();
+}
+
+bool server::read_all(int fd, void* data, size_t len) {
+    char* pos = static_cast<char*>(data);
+    while (len > 0) {
+        ssize_t done = read(fd, pos, len);
+        if (done < 0 && errno == EINTR) {
+            continue;
+        }
+        if (done <= 0) {
+            return false;
+        }
+        pos += done;
+        len -= done;
+    }
+    return true;
+}
+
+bool server::write_all(int fd, const void* data, size_t len) {
+    const char* pos = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t done = write(fd, pos, len);
+        if (done < 0 && errno == EINTR) {
+            continue;
+        }
+        if (done <= 0) {
+            return false;
+        }
+        pos += done;
+        len -= done;
+    }
+    return true;
+}
+
+bool server::read_string(int fd, std::string& str) {
+    uint32_t len;
+    if (!read_all(fd, &len, sizeof(len)) || (len > MAX_JOB_STRING_LEN)) {
+        return false;
+    }
+    str.resize(len);
+    return read_all(fd, str.data(), len);
+}
+
+bool server::write_string(int fd, const std::string& str) {
+    uint32_t len = str.size();
+    return write_all(fd, &len, sizeof(len)) && \
+           write_all(fd, str.data(), str.size());
+}
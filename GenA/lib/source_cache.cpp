@@ -0,0 +1,393 @@
+// source_cache.cpp
+// C++ file for the source_cache class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "source_cache.hpp"
+#include "asm_line.hpp"
+#include "isa.hpp"
+#include "source_manager.hpp"
+#include "chunk_runner.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <utility>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <sys/stat.h>
+
+// Constants.
+const char PSEUDO_OP_SYMBOL = '.';
+const char CONTINUE_SYMBOL = '\\';
+// The number of lines each thread parses at a time.
+const size_t PARSE_CHUNK_SIZE = 1024;
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+const int64_t NS_PER_S = 1000000000;
+
+bool file_stamp::operator==(const file_stamp& other) const {
+    return (device == other.device) && (inode == other.inode) && \
+           (size == other.size) && (mtime_ns == other.mtime_ns);
+}
+
+// Constructor.
+source_cache::source_cache(const isa& cpu_isa, bool copy_files) : \
+                           cpu_isa_(cpu_isa), sources_(copy_files), \
+                           num_restored_(0) {}
+
+// Destructor
+source_cache::~source_cache() {};
+
+// Public functions.
+const std::vector<parsed_line>* source_cache::load(const std::string& path, \
+                                                   const chunk_runner& runner, \
+                                                   const build_db* db) {
+    file_stamp current;
+
+    if (!stamp(path, current)) {
+        return NULL;
+    }
+    std::string key = key_of(path);
+    auto cached = files_.find(key);
+    if ((cached != files_.end()) && (cached->second->stamp == current)) {
+        return &cached->second->lines;
+    }
+
+    size_t file = sources_.open(path);
+    if (file == SOURCE_INVALID) {
+        return NULL;
+    }
+    uint64_t contents = hash(sources_.text(file));
+    if (cached != files_.end()) {
+        // A file whose stamp changed but whose contents did not keeps its
+        // lines.
+        if (cached->second->hash == contents) {
+            sources_.close(file);
+            cached->second->stamp = current;
+            return &cached->second->lines;
+        }
+        stale_.push_back(std::move(cached->second));
+        files_.erase(cached);
+    }
+    files_[key] = std::make_unique<cached_file>();
+    cached_file& entry = *files_[key];
+    entry.file = file;
+    entry.path = path;
+    entry.stamp = current;
+    entry.hash = contents;
+    parsed_paths_.push_back(key);
+    // A restored file keeps its own copy of the lexed file, so its text is
+    // not kept open.
+    const build_db::file_record* record = (db != NULL) ? \
+                                          db->file(key, contents) : NULL;
+    if ((record != NULL) && restore(*record, entry, runner)) {
+        sources_.close(file);
+        entry.file = SOURCE_INVALID;
+        num_restored_++;
+        intern_lines(entry.lines);
+        return &entry.lines;
+    }
+    entry.work = sources_.work(file);
+    entry.work_size = sources_.text(file).size();
+    parse_file(file, entry, runner);
+    intern_lines(entry.lines);
+    return &entry.lines;
+}
+
+bool source_cache::record(const std::vector<std::string>& paths, \
+                          build_db& db) const {
+    std::unordered_set<std::string> keys;
+    bool changed = false;
+
+    for (const std::string& path : paths) {
+        auto cached = files_.find(key_of(path));
+        if (cached == files_.end()) {
+            continue;
+        }
+        keys.insert(cached->first);
+        if (db.file(cached->first, cached->second->hash) == NULL) {
+            record_file(cached->first, *cached->second, db);
+            changed = true;
+        }
+    }
+    return db.keep_files(keys) || changed;
+}
+
+void source_cache::record_file(const std::string& key, \
+                               const cached_file& entry, build_db& db) const {
+    build_db::file_record record;
+    // This gives the slice of the lexed file a view points into.
+    auto work_slice = [&](std::string_view view) {
+        build_db::slice part = {0, 0};
+        if (!view.empty() && (view.data() >= entry.work) && \
+            (view.data() + view.size() <= entry.work + entry.work_size)) {
+            part.pos = view.data() - entry.work;
+            part.len = view.size();
+        }
+        return part;
+    };
+
+    record.hash = entry.hash;
+    record.work.assign(entry.work, entry.work_size);
+    for (const parsed_line& parsed : entry.lines) {
+        build_db::line_record line;
+        line.line_num = parsed.line_num;
+        line.pseudo = parsed.pseudo;
+        line.work = {static_cast<uint64_t>(parsed.work - entry.work), \
+                     parsed.len};
+        line.text = {record.text.size(), parsed.text.size()};
+        record.text.append(parsed.text);
+        line.label = work_slice(parsed.line.label());
+        line.op_name = work_slice(parsed.line.op_name());
+        line.operand = work_slice(parsed.line.operand());
+        if (parsed.pseudo || (parsed.line.origin_file() == ASM_INVALID)) {
+            line.macro = BUILD_DB_INVALID;
+        }
+        else if (parsed.line.macro() == NULL) {
+            line.macro = BUILD_DB_NO_MACRO;
+        }
+        else {
+            line.macro = cpu_isa_.macro_index(parsed.line.macro());
+        }
+        const op_arg* args = parsed.line.arguments();
+        for (size_t i = 0; i < parsed.line.num_arguments(); i++) {
+            line.args.push_back({args[i].pos, args[i].len, args[i].pc});
+        }
+        line.diagnostic = parsed.diagnostic;
+        record.lines.push_back(std::move(line));
+    }
+    db.set_file(key, std::move(record));
+}
+
+void source_cache::release_stale(void) {
+    for (std::unique_ptr<cached_file>& entry : stale_) {
+        if (entry->file != SOURCE_INVALID) {
+            sources_.close(entry->file);
+        }
+    }
+    stale_.clear();
+}
+
+void source_cache::clear_parsed_paths(void) {
+    parsed_paths_.clear();
+}
+
+bool source_cache::stamp(const std::string& path, file_stamp& out) {
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+    out.device = info.st_dev;
+    out.inode = info.st_ino;
+    out.size = info.st_size;
+    out.mtime_ns = static_cast<int64_t>(info.st_mtim.tv_sec) * NS_PER_S + \
+                   info.st_mtim.tv_nsec;
+    return true;
+}
+
+// Accessors
+const std::vector<std::string>& source_cache::parsed_paths(void) const {
+    return parsed_paths_;
+}
+size_t source_cache::num_restored(void) const {
+    return num_restored_;
+}
+symbol_pool& source_cache::symbols(void) {
+    return symbols_;
+}
+const symbol_pool& source_cache::symbols(void) const {
+    return symbols_;
+}
+
+// Helper functions.
+void source_cache::parse_file(size_t file, cached_file& entry, \
+                              const chunk_runner& runner) {
+    std::vector<parsed_line>& lines = entry.lines;
+    std::string_view text = sources_.text(file);
+    char* work = sources_.work(file);
+    std::string_view file_path = entry.path;
+    // The start and length of a line being continued, and where its first
+    // line starts in the file.
+    bool continuing = false;
+    size_t cont_start = 0;
+    size_t cont_len = 0;
+    size_t cont_first = 0;
+    size_t line_num = 0;
+    size_t pos = 0;
+
+    // Split the file into logical lines in order.
+    while (pos < text.size()) {
+        size_t start = pos;
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        size_t len = end - start;
+        pos = end + 1;
+        line_num++;
+        // If the continue symbol is at the end of the line, move the line
+        // without it up against the part of the line before so the whole
+        // line is contiguous when it ends.
+        bool cont = (len > 0) && (text[end - 1] == CONTINUE_SYMBOL);
+        if (cont) {
+            len--;
+        }
+        std::string_view line_text = text.substr(start, len);
+        if (continuing) {
+            std::memmove(work + cont_start + cont_len, work + start, len);
+            start = cont_start;
+            len += cont_len;
+        }
+        if (cont) {
+            if (!continuing) {
+                cont_first = start;
+            }
+            continuing = true;
+            cont_start = start;
+            cont_len = len;
+            continue;
+        }
+        // A continued line has no contiguous original text, so the text of
+        // its lines is joined and kept by the source manager.
+        if (continuing) {
+            line_text = sources_.join(file, cont_first, end - cont_first);
+        }
+        continuing = false;
+        cont_len = 0;
+        lines.push_back({line_num, (len > 0) && \
+                         (work[start] == PSEUDO_OP_SYMBOL), work + start, \
+                         len, line_text, \
+                         asm_line(ASM_INVALID, ASM_INVALID, ASM_INVALID, \
+                                  ASM_INVALID, ASM_INVALID), ""});
+    }
+
+    // Lex and match the lines in chunks. Each line is lexed in its own part
+    // of the writable copy, so chunks do not share anything they write.
+    size_t num_chunks = (lines.size() + PARSE_CHUNK_SIZE - 1) / \
+                        PARSE_CHUNK_SIZE;
+    entry.arenas.resize(num_chunks);
+    runner.run(num_chunks, [&](size_t chunk) {
+        std::ostringstream diag;
+        size_t end = std::min((chunk + 1) * PARSE_CHUNK_SIZE, lines.size());
+        for (size_t i = chunk * PARSE_CHUNK_SIZE; i < end; i++) {
+            parsed_line& parsed = lines.at(i);
+            if (parsed.pseudo) {
+                continue;
+            }
+            parsed.line = cpu_isa_.parse_asm(parsed.work, parsed.len, \
+                                             parsed.text, file_path, \
+                                             entry.arenas.at(chunk), diag);
+            if (diag.tellp() > 0) {
+                parsed.diagnostic = diag.str();
+                diag.str("");
+            }
+        }
+    });
+}
+
+void source_cache::intern_lines(std::vector<parsed_line>& lines) {
+    for (parsed_line& entry : lines) {
+        if (!entry.pseudo) {
+            entry.line.intern(symbols_);
+        }
+    }
+}
+
+bool source_cache::restore(const build_db::file_record& record, \
+                           cached_file& entry, \
+                           const chunk_runner& runner) const {
+    entry.work_copy = record.work;
+    entry.text_copy = record.text;
+    entry.work = entry.work_copy.data();
+    entry.work_size = entry.work_copy.size();
+    std::string_view work(entry.work_copy);
+    std::string_view text(entry.text_copy);
+
+    // The record must fit the ISA before any line is restored.
+    for (const build_db::line_record& line : record.lines) {
+        if ((line.macro != BUILD_DB_INVALID) && \
+            (line.macro != BUILD_DB_NO_MACRO) && \
+            (cpu_isa_.macro_at(line.macro) == NULL)) {
+            return false;
+        }
+        // Arguments are slices of the operand.
+        if (line.args.size() > OP_MAX_ARGS) {
+            return false;
+        }
+        for (const build_db::arg_record& arg : line.args) {
+            if ((arg.pos > line.operand.len) || \
+                (arg.len > line.operand.len - arg.pos)) {
+                return false;
+            }
+        }
+    }
+
+    entry.lines.resize(record.lines.size(), \
+                       {0, false, NULL, 0, std::string_view(), \
+                        asm_line(ASM_INVALID, ASM_INVALID, ASM_INVALID, \
+                                 ASM_INVALID, ASM_INVALID), ""});
+    // Lines are restored in chunks like they are parsed.
+    size_t num_chunks = (record.lines.size() + PARSE_CHUNK_SIZE - 1) / \
+                        PARSE_CHUNK_SIZE;
+    entry.arenas.resize(num_chunks);
+    runner.run(num_chunks, [&](size_t chunk) {
+        op_arg args[OP_MAX_ARGS];
+        size_t end = std::min((chunk + 1) * PARSE_CHUNK_SIZE, \
+                              record.lines.size());
+        for (size_t i = chunk * PARSE_CHUNK_SIZE; i < end; i++) {
+            const build_db::line_record& line = record.lines.at(i);
+            parsed_line& restored = entry.lines.at(i);
+            restored.line_num = line.line_num;
+            restored.pseudo = (line.pseudo != 0);
+            restored.work = entry.work + line.work.pos;
+            restored.len = line.work.len;
+            restored.text = text.substr(line.text.pos, line.text.len);
+            restored.diagnostic = line.diagnostic;
+            if (line.macro == BUILD_DB_INVALID) {
+                continue;
+            }
+            size_t num_args = line.args.size();
+            for (size_t j = 0; j < num_args; j++) {
+                const build_db::arg_record& arg = line.args.at(j);
+                args[j] = {arg.pos, arg.len, arg.pc != 0, SYMBOL_NONE};
+            }
+            restored.line = asm_line(entry.path, restored.text, \
+                                     work.substr(line.label.pos, \
+                                                 line.label.len), \
+                                     work.substr(line.op_name.pos, \
+                                                 line.op_name.len), \
+                                     work.substr(line.operand.pos, \
+                                                 line.operand.len), \
+                                     (line.macro == BUILD_DB_NO_MACRO) ? \
+                                     NULL : cpu_isa_.macro_at(line.macro), \
+                                     entry.arenas.at(chunk).copy(args, \
+                                                                 num_args), \
+                                     num_args);
+        }
+    });
+    return true;
+}
+
+std::string source_cache::key_of(const std::string& path) {
+    std::error_code error;
+    std::string key = std::filesystem::absolute(path, error). \
+                      lexically_normal().string();
+    return error ? path : key;
+}
+
+uint64_t source_cache::hash(std::string_view text) {
+    uint64_t seed = FNV_OFFSET;
+    for (unsigned char c : text) {
+        seed ^= c;
+        seed *= FNV_PRIME;
+    }
+    return seed;
+}
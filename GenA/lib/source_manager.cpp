@@ -0,0 +1,221 @@
+// source_manager.cpp
+// C++ file for the source_manager class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "source_manager.hpp"
+#include <stdlib.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+// Constants.
+const char CONTINUE_SYMBOL = '\\';
+// The size of reads from files that are copied.
+const size_t READ_CHUNK_SIZE = 65536;
+// The name of the anonymous files copies are kept in.
+const char COPY_NAME[] = "gena-source";
+
+// Constructor.
+source_manager::source_manager(bool copy) : copy_(copy) {}
+
+// Destructor
+source_manager::~source_manager() {
+    for (size_t file = 0; file < files_.size(); file++) {
+        close(file);
+    }
+}
+
+// Public functions.
+size_t source_manager::open(const std::string& path) {
+    int fd;
+
+    files_.emplace_back();
+    source_file& file = files_.back();
+    file.path = path;
+    file.text = NULL;
+    file.work = NULL;
+    file.size = 0;
+
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        files_.pop_back();
+        return SOURCE_INVALID;
+    }
+    // A file that is not copied is mapped directly if it can be, otherwise
+    // it is copied and the copy is mapped.
+    bool mapped = !copy_ && map_file(fd, file);
+    if (!mapped) {
+        int copy_fd = copy_file(fd);
+        mapped = (copy_fd >= 0) && map_file(copy_fd, file);
+        if (copy_fd >= 0) {
+            ::close(copy_fd);
+        }
+    }
+    ::close(fd);
+    if (!mapped) {
+        files_.pop_back();
+        return SOURCE_INVALID;
+    }
+
+    file.line_starts.push_back(0);
+    const char* pos = file.text;
+    const char* end = file.text + file.size;
+    while (pos != end) {
+        const void* newline = std::memchr(pos, '\n', end - pos);
+        if (newline == NULL) {
+            break;
+        }
+        pos = static_cast<const char*>(newline) + 1;
+        if (pos != end) {
+            file.line_starts.push_back(pos - file.text);
+        }
+    }
+    return files_.size() - 1;
+}
+
+size_t source_manager::line_of(size_t file, size_t offset) const {
+    const std::vector<size_t>& starts = files_.at(file).line_starts;
+    return std::upper_bound(starts.begin(), starts.end(), offset) - \
+           starts.begin();
+}
+
+std::string_view source_manager::line_text(size_t file, size_t line_num) \
+                                           const {
+    const source_file& source = files_.at(file);
+    if ((line_num == 0) || (line_num > source.line_starts.size()) || \
+        (source.size == 0)) {
+        return std::string_view();
+    }
+    size_t start = source.line_starts.at(line_num - 1);
+    size_t end = (line_num < source.line_starts.size()) ? \
+                 source.line_starts.at(line_num) - 1 : source.size;
+    if ((end > start) && (source.text[end - 1] == '\n')) {
+        end--;
+    }
+    return std::string_view(source.text + start, end - start);
+}
+
+std::string_view source_manager::join(size_t file, size_t offset, size_t len) {
+    std::string_view lines = text(file).substr(offset, len);
+    std::string joined;
+    size_t pos = 0;
+    size_t newline;
+    // Copy each line without the continue symbol before its newline.
+    while ((newline = lines.find('\n', pos)) != std::string_view::npos) {
+        size_t end = newline;
+        if ((end > pos) && (lines[end - 1] == CONTINUE_SYMBOL)) {
+            end--;
+        }
+        joined.append(lines.substr(pos, end - pos));
+        pos = newline + 1;
+    }
+    joined.append(lines.substr(pos));
+    files_.at(file).joined.push_back(std::move(joined));
+    return files_.at(file).joined.back();
+}
+
+void source_manager::close(size_t file) {
+    source_file& source = files_.at(file);
+    if (source.text != NULL) {
+        munmap(const_cast<char*>(source.text), source.size);
+        munmap(source.work, source.size);
+    }
+    source.text = NULL;
+    source.work = NULL;
+    source.size = 0;
+    source.line_starts.clear();
+    source.joined.clear();
+}
+
+// Accessors
+std::string_view source_manager::text(size_t file) const {
+    return std::string_view(files_.at(file).text, files_.at(file).size);
+}
+char* source_manager::work(size_t file) {
+    return files_.at(file).work;
+}
+const std::string& source_manager::path(size_t file) const {
+    return files_.at(file).path;
+}
+size_t source_manager::num_lines(size_t file) const {
+    return files_.at(file).line_starts.size();
+}
+size_t source_manager::num_files(void) const {
+    return files_.size();
+}
+
+// Helper functions.
+bool source_manager::map_file(int fd, source_file& file) {
+    struct stat info;
+
+    if ((fstat(fd, &info) != 0) || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+    // An empty file has nothing to map.
+    file.size = info.st_size;
+    if (file.size == 0) {
+        return true;
+    }
+    void* text = mmap(NULL, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    void* work = mmap(NULL, file.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, \
+                      fd, 0);
+    if ((text == MAP_FAILED) || (work == MAP_FAILED)) {
+        if (text != MAP_FAILED) {
+            munmap(text, file.size);
+        }
+        if (work != MAP_FAILED) {
+            munmap(work, file.size);
+        }
+        file.size = 0;
+        return false;
+    }
+    file.text = static_cast<const char*>(text);
+    file.work = static_cast<char*>(work);
+    return true;
+}
+
+int source_manager::copy_file(int fd) {
+    char buffer[READ_CHUNK_SIZE];
+
+    int copy_fd = memfd_create(COPY_NAME, MFD_CLOEXEC);
+    if (copy_fd < 0) {
+        return -1;
+    }
+    // The file is copied until it ends, so a file that changes size while it
+    // is copied is kept as far as it was read.
+    while (true) {
+        ssize_t done = ::read(fd, buffer, sizeof(buffer));
+        if ((done < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (done < 0) {
+            ::close(copy_fd);
+            return -1;
+        }
+        if (done == 0) {
+            return copy_fd;
+        }
+        for (ssize_t pos = 0; pos < done;) {
+            ssize_t written = ::write(copy_fd, buffer + pos, done - pos);
+            if ((written < 0) && (errno == EINTR)) {
+                continue;
+            }
+            if (written <= 0) {
+                ::close(copy_fd);
+                return -1;
+            }
+            pos += written;
+        }
+    }
+}
@@ -0,0 +1,95 @@
+// symbol_pool.cpp
+// C++ file for the symbol_pool class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "symbol_pool.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Constants.
+const size_t SYMBOL_POOL_INITIAL_SLOTS = 1024;
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+// Constructor.
+symbol_pool::symbol_pool() : slots_(SYMBOL_POOL_INITIAL_SLOTS, SYMBOL_NONE) {}
+
+// Destructor
+symbol_pool::~symbol_pool() {};
+
+// Public functions.
+uint32_t symbol_pool::intern(std::string_view name) {
+    uint64_t name_hash = hash(name);
+    size_t slot = slot_of(name, name_hash);
+
+    if (slots_[slot] != SYMBOL_NONE) {
+        return slots_[slot];
+    }
+    uint32_t id = slices_.size();
+    slices_.push_back({names_.size(), name.size(), name_hash});
+    names_.append(name);
+    slots_[slot] = id;
+    // Keep the table at most half full so probes stay short.
+    if (slices_.size() * 2 > slots_.size()) {
+        grow();
+    }
+    return id;
+}
+
+uint32_t symbol_pool::find(std::string_view name) const {
+    return slots_[slot_of(name, hash(name))];
+}
+
+std::string_view symbol_pool::name(uint32_t id) const {
+    const name_slice& slice = slices_.at(id);
+    return std::string_view(names_).substr(slice.pos, slice.len);
+}
+
+// Accessors
+size_t symbol_pool::size(void) const {
+    return slices_.size();
+}
+
+// Helper functions.
+size_t symbol_pool::slot_of(std::string_view name, uint64_t hash) const {
+    size_t mask = slots_.size() - 1;
+    size_t slot = hash & mask;
+
+    // Probe linearly until the name or an empty slot is found.
+    while (slots_[slot] != SYMBOL_NONE) {
+        const name_slice& slice = slices_[slots_[slot]];
+        if ((slice.hash == hash) && (slice.len == name.size()) && \
+            (names_.compare(slice.pos, slice.len, name) == 0)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void symbol_pool::grow(void) {
+    size_t mask = slots_.size() * 2 - 1;
+
+    slots_.assign(slots_.size() * 2, SYMBOL_NONE);
+    for (uint32_t id = 0; id < slices_.size(); id++) {
+        size_t slot = slices_[id].hash & mask;
+        while (slots_[slot] != SYMBOL_NONE) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = id;
+    }
+}
+
+uint64_t symbol_pool::hash(std::string_view name) {
+    uint64_t seed = FNV_OFFSET;
+    for (unsigned char c : name) {
+        seed ^= c;
+        seed *= FNV_PRIME;
+    }
+    return seed;
+}
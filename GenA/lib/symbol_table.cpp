@@ -0,0 +1,38 @@
+// symbol_table.cpp
+// C++ file for the symbol_table class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "symbol_table.hpp"
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+
+// Constructor.
+symbol_table::symbol_table() {}
+
+// Destructor
+symbol_table::~symbol_table() {};
+
+// Public functions.
+bool symbol_table::define(uint32_t id, const symbol_entry& entry) {
+    if (id >= entries_.size()) {
+        entries_.resize(id + 1, {0, SYMBOL_UNDEFINED, 0, 0});
+    }
+    if (entries_[id].kind != SYMBOL_UNDEFINED) {
+        return false;
+    }
+    entries_[id] = entry;
+    defined_.push_back(id);
+    return true;
+}
+
+void symbol_table::set_value(uint32_t id, size_t value) {
+    entries_.at(id).value = value;
+}
+
+// Accessors
+const std::vector<uint32_t>& symbol_table::defined(void) const {
+    return defined_;
+}
@@ -0,0 +1,75 @@
+// user_lib.cpp
+// C++ file for the user_lib class implementation.
+// Revision History:
+// 10/17/26 agent Initial revision.
+
+// Included libraries.
+#include "user_lib.hpp"
+#include "diagnostics.hpp"
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+#include <dlfcn.h>
+
+// Constructor.
+user_lib::user_lib(const std::string& lib_path) : handle_(NULL) {
+    // Nothing is loaded for an empty path, compiling the library already
+    // failed and displayed an error.
+    if (lib_path.empty()) {
+        return;
+    }
+    // A path without a slash would be searched for in the system library
+    // paths instead of being opened relative to the working directory.
+    std::string path = lib_path;
+    if (path.find('/') == std::string::npos) {
+        path = "./" + path;
+    }
+    handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle_ == NULL) {
+        const char* error = dlerror();
+        diagnostics::global().report({DIAG_ERROR, "lib-open", "", 0, 0}, \
+                                     [&](std::ostream& out) {
+            out << "Cannot open library: " << error;
+        });
+    }
+}
+
+// Destructor
+user_lib::~user_lib() {
+    if (handle_ != NULL) {
+        dlclose(handle_);
+    }
+}
+
+// Public functions.
+void* user_lib::symbol(const std::string& name, bool required) {
+    auto cached = symbols_.find(name);
+    if (cached != symbols_.end()) {
+        return cached->second;
+    }
+
+    void* address = NULL;
+    if (handle_ != NULL) {
+        // Reset errors so a NULL symbol can be told apart from a missing one.
+        dlerror();
+        address = dlsym(handle_, name.c_str());
+        if (dlerror() != NULL) {
+            address = NULL;
+        }
+    }
+    if ((address == NULL) && required) {
+        unresolved_.push_back(name);
+    }
+    symbols_.insert({name, address});
+    return address;
+}
+
+// Accessors
+bool user_lib::is_open(void) const {
+    return handle_ != NULL;
+}
+const std::vector<std::string>& user_lib::unresolved(void) const {
+    return unresolved_;
+}
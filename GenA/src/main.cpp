@@ -13,7 +13,14 @@
 #include <filesystem>
 #include <fstream>
 #include "assembler.hpp"
+#include "image_writer.hpp"
+#include "server.hpp"
+#include "diagnostics.hpp"
 #include <streambuf>
+#include <thread>
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 // Used constants.
 const char *FILE_FLAG = "--file";
@@ -24,6 +31,16 @@ const char *VERSION_FLAG = "--version";
 const char *LIST_FLAG = "--list";
 const char *LOG_FLAG = "--log";
 const char *VERBOSE_FLAG = "--verbose";
+const char *CACHE_FLAG = "--cache";
+const char *REBUILD_FLAG = "--rebuild";
+const char *FORMAT_FLAG = "--format";
+const char *JOBS_FLAG = "--jobs";
+const char *DAEMON_FLAG = "--daemon";
+const char *SERVER_FLAG = "--server";
+const char *INCREMENTAL_FLAG = "--incremental";
+const char *WATCH_FLAG = "--watch";
+const char *STATS_FLAG = "--stats";
+const char *RELAX_FLAG = "--relax";
  
 const char  *FILE_FLAG_SHORT = "-f";
 const char *ISA_FLAG_SHORT = "-i";
@@ -33,8 +50,19 @@ const char *VERSION_FLAG_SHORT = "-r";
 const char *LIST_FLAG_SHORT = "-t";
 const char *LOG_FLAG_SHORT = "-l";
 const char *VERBOSE_FLAG_SHORT = "-v";
+const char *CACHE_FLAG_SHORT = "-c";
+const char *REBUILD_FLAG_SHORT = "-b";
+const char *FORMAT_FLAG_SHORT = "-x";
+const char *JOBS_FLAG_SHORT = "-j";
+const char *DAEMON_FLAG_SHORT = "-d";
+const char *SERVER_FLAG_SHORT = "-s";
+const char *INCREMENTAL_FLAG_SHORT = "-n";
+const char *WATCH_FLAG_SHORT = "-w";
+const char *STATS_FLAG_SHORT = "-m";
+const char *RELAX_FLAG_SHORT = "-a";
 const char *LOG_FILE_NAME = "log_gena";
 const char *DEFAULT_OUTPUT_PATH = "output_gena";
+const char *STATS_STDOUT = "-";
 
 
 // Null stream buffer to discard output
@@ -57,21 +85,55 @@ void usageError(char *prog) {
 	<< "\t\tSpecify the ISA file path (required).\n" \
 	<< "\t-o, --output <output file>\n" \
 	<< "\t\tSpecify the output file path (optional).\n" \
+	<< "\t-x, --format <hex|srec|bin>\n" \
+	<< "\t\tSpecify the output file format, Intel HEX, Motorola S-record\n" \
+	<< "\t\tor raw binary (optional, hex by default).\n" \
 	<< "\t-t, --list\n" \
 	<< "\t\tProduce a listing file.\n" \
+	<< "\t-a, --relax\n" \
+	<< "\t\tEncode each instruction the ISA can relax in its shortest\n" \
+	<< "\t\tform that reaches its target.\n" \
 	<< "\t-l, --log\n" \
 	<< "\t\tLog all output to gena.log in the current directory.\n" \
 	<< "\t-v, --verbose\n" \
 	<< "\t\tOutput all information to the terminal.\n" \
+	<< "\t-j, --jobs <number of threads>\n" \
+	<< "\t\tParse and encode the program with this many threads, 0 uses\n" \
+	<< "\t\tevery core (optional, 1 by default).\n" \
+	<< "\t-c, --cache <cache directory>\n" \
+	<< "\t\tSpecify the ISA user library cache directory (optional).\n" \
+	<< "\t-b, --rebuild\n" \
+	<< "\t\tRebuild the ISA user library even if it is cached.\n" \
+	<< "\t-n, --incremental <build database>\n" \
+	<< "\t\tReuse the files and instructions recorded in the build\n" \
+	<< "\t\tdatabase that did not change and record this build in it\n" \
+	<< "\t\t(optional).\n" \
+	<< "\t-m, --stats <stats file>\n" \
+	<< "\t\tWrite the time of each phase and counts of the work done as\n" \
+	<< "\t\tJSON to the file, or to the terminal if it is - (optional).\n" \
+	<< "\t-d, --daemon <socket path>\n" \
+	<< "\t\tServe assembly jobs on a Unix socket, keeping ISAs and parsed\n" \
+	<< "\t\tfiles loaded between jobs.\n" \
+	<< "\t-s, --server <socket path>\n" \
+	<< "\t\tRun on the server at the socket, or locally if there is no\n" \
+	<< "\t\tserver (optional).\n" \
+	<< "\t-w, --watch\n" \
+	<< "\t\tAssemble again whenever a file of the program, the ISA file\n" \
+	<< "\t\tor its user function file changes, keeping the ISA and\n" \
+	<< "\t\tunchanged files loaded.\n" \
 	<< "\t-h, --help\n" \
 	<< "\t\tDisplay this help message and exit.\n" \
 	<< "\t-r, --version\n" \
 	<< "\t\tDisplay the version information and exit.\n" \
 	<< "\nNotes:\n" \
 	<< "\t- The --output flag is optional. If not specified, the default\n" \
-	<< "\t  output file will be output_gena.HEX in the working directory .\n" \
+	<< "\t  output file will be output_gena with the extension of the\n" \
+	<< "\t  format in the working directory.\n" \
 	<< "\t- Both --file and --isa flags must be used with valid paths.\n" \
 	<< "\t- Both --log and --verbose flags cannot be used simultaneously.\n" \
+	<< "\t- If --cache is not specified, the user library is cached in\n" \
+	<< "\t  $GENA_CACHE_DIR, $XDG_CACHE_HOME/gena or ~/.cache/gena.\n" \
+	<< "\t- Jobs run on a server use the environment of the server.\n" \
 	<< std::endl;
 }
 
@@ -109,13 +171,20 @@ void version_flag_handler(void) {
 	exit(EXIT_SUCCESS);
 }
 
-// Main function.
-int main(int argc, char* argv[]) {
+// This function takes in the command line arguments of a job and the server
+// running it, or NULL if it is run directly, and assembles the program.
+// Returns the exit status.
+int assemble(int argc, char* argv[], server* daemon) {
     // These variables hold the data parsed from the command line arguments. 
 	std::filesystem::path main_file_path;
 	std::filesystem::path isa_file_path;
 	std::filesystem::path output_file_path;
-	bool list, log, verbose, done;
+	std::string cache_dir;
+	std::string build_db_path;
+	std::string stats_path;
+	output_format format;
+	size_t jobs;
+	bool list, log, verbose, rebuild, relax, done;
 
 	// Call the usage error and exit if there are no command line arguments.
 	if (argc == 1) {
@@ -127,6 +196,11 @@ int main(int argc, char* argv[]) {
 	list = false;
 	log = false;
 	verbose = false;
+	rebuild = false;
+	relax = false;
+	done = false;
+	format = FORMAT_INTEL_HEX;
+	jobs = 1;
 	// Parse the arguments.
 	for (int i = 1; i < argc; i++) {
 		// If the main file flag is set, handle it.
@@ -139,10 +213,67 @@ int main(int argc, char* argv[]) {
 			 (std::strcmp(argv[i], ISA_FLAG_SHORT) == 0)) && (i != argc - 1)) {
 			path_flag_handler(isa_file_path, argv[i + 1], argv[0]);
 		}
-		// If the output folder flag is set, handle it.
+		// If the output file flag is set, save it. The file does not need to
+		// exist yet.
 		if (((std::strcmp(argv[i], OUT_FLAG) == 0) || 
 			 (std::strcmp(argv[i], OUT_FLAG_SHORT) == 0)) && (i != argc - 1)) {
-			path_flag_handler(output_file_path, argv[i + 1], argv[0]);
+			output_file_path = argv[i + 1];
+		}
+		// If the format flag is set, make sure it names a format.
+		if (((std::strcmp(argv[i], FORMAT_FLAG) == 0) || 
+			 (std::strcmp(argv[i], FORMAT_FLAG_SHORT) == 0)) && (i != argc - 1)) {
+			format = image_writer::parse_format(argv[i + 1]);
+			if (format == FORMAT_INVALID) {
+				std::cerr << "Error: Invalid output format: " << argv[i + 1] \
+						  << std::endl;
+				usageError(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+		}
+		// If the cache directory flag is set, save it. The directory does not
+		// need to exist yet.
+		if (((std::strcmp(argv[i], CACHE_FLAG) == 0) || 
+			 (std::strcmp(argv[i], CACHE_FLAG_SHORT) == 0)) && (i != argc - 1)) {
+			cache_dir = argv[i + 1];
+		}
+		// If the incremental flag is set, save the build database path. The
+		// database does not need to exist yet.
+		if (((std::strcmp(argv[i], INCREMENTAL_FLAG) == 0) || 
+			 (std::strcmp(argv[i], INCREMENTAL_FLAG_SHORT) == 0)) && \
+			(i != argc - 1)) {
+			build_db_path = argv[i + 1];
+		}
+		// If the stats flag is set, save the stats file path.
+		if (((std::strcmp(argv[i], STATS_FLAG) == 0) || 
+			 (std::strcmp(argv[i], STATS_FLAG_SHORT) == 0)) && \
+			(i != argc - 1)) {
+			stats_path = argv[i + 1];
+		}
+		// If the jobs flag is set, make sure it is a number of threads.
+		if (((std::strcmp(argv[i], JOBS_FLAG) == 0) || 
+			 (std::strcmp(argv[i], JOBS_FLAG_SHORT) == 0)) && (i != argc - 1)) {
+			try {
+				jobs = std::stoul(argv[i + 1]);
+			}
+			catch (const std::exception& e) {
+				std::cerr << "Error: Invalid number of jobs: " << argv[i + 1] \
+						  << std::endl;
+				usageError(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			if (jobs == 0) {
+				jobs = std::max(1U, std::thread::hardware_concurrency());
+			}
+		}
+		// If the rebuild flag is set, handle it.
+		if ((std::strcmp(argv[i], REBUILD_FLAG) == 0) || 
+			(std::strcmp(argv[i], REBUILD_FLAG_SHORT) == 0)) {
+			rebuild = true;
+		}
+		// If the relax flag is set, handle it.
+		if ((std::strcmp(argv[i], RELAX_FLAG) == 0) || 
+			(std::strcmp(argv[i], RELAX_FLAG_SHORT) == 0)) {
+			relax = true;
 		}
 		// If the help flag is set, handle it.
 		if ((std::strcmp(argv[i], HELP_FLAG) == 0) || 
@@ -198,6 +329,7 @@ int main(int argc, char* argv[]) {
         }
     }
     // Backup original buffers
+    NullStreamBuf null_buf;
     std::streambuf* cerr_buf = std::cerr.rdbuf();
     std::streambuf* clog_buf = std::clog.rdbuf();
 
@@ -216,26 +348,44 @@ int main(int argc, char* argv[]) {
         std::clog.rdbuf(clog_buf);
     }
     else {
-        NullStreamBuf null_buf;
-        // Suppress all output.
+        // Suppress all output, diagnostics are not even formatted.
         std::cerr.rdbuf(&null_buf);
         std::clog.rdbuf(&null_buf);
+        diagnostics::global().set_min_level(NUM_DIAG_LEVELS);
     }
 
     if (output_file_path.empty()) {
-        output_file_path = DEFAULT_OUTPUT_PATH;
+        output_file_path = std::string(DEFAULT_OUTPUT_PATH) + "." + \
+                           FORMAT_NAMES.at(format);
     }
 
-    // Create and use the assembler object.
-    assembler gena(main_file_path, isa_file_path, output_file_path, verbose, \
-    list);
-    if (gena.first_pass()) {
-        done = gena.second_pass();
+    // Create and use the assembler object. On a server the ISA is used as
+    // loaded if it is unchanged.
+    warm_isa* warm = NULL;
+    if ((daemon != NULL) && !rebuild) {
+        warm = daemon->find(isa_file_path, cache_dir);
+    }
+    std::unique_ptr<assembler> gena;
+    if (warm != NULL) {
+        gena = std::make_unique<assembler>(main_file_path, *warm->cpu_isa, \
+               *warm->sources, output_file_path, format, verbose, list, relax, \
+               jobs, build_db_path);
+    }
+    else {
+        gena = std::make_unique<assembler>(main_file_path, isa_file_path, \
+               output_file_path, format, verbose, list, relax, cache_dir, \
+               rebuild, jobs, build_db_path);
+    }
+    if (gena->first_pass()) {
+        done = gena->second_pass();
     }
     else {
+        diagnostics::global().flush();
         std::cout << "Failed. See log file using -l flag." << std::endl;
     }
-    // Reset std::cerr and std::clog to their original buffers before exiting.
+    // Reset std::cerr and std::clog to their original buffers before exiting,
+    // after writing the diagnostics still buffered for them.
+    diagnostics::global().flush();
     std::cerr.rdbuf(cerr_buf);
     std::clog.rdbuf(clog_buf);
 
@@ -248,8 +398,100 @@ int main(int argc, char* argv[]) {
     }
     else {
         std::cout << "Failed." << std::endl;
+    }
+    if (!stats_path.empty()) {
+        assembly_stats stats = gena->stats();
+        stats.isa_path = isa_file_path.string();
+        stats.success = done;
+        stats.diag_counts = diagnostics::global().counts();
+        if (stats_path == STATS_STDOUT) {
+            stats.write_json(std::cout);
+        }
+        else {
+            std::ofstream stats_file(stats_path);
+            stats.write_json(stats_file);
+            if (!stats_file) {
+                std::cerr << "Error: Cannot write stats file " << stats_path \
+                          << std::endl;
+            }
+        }
+    }
+    // Let the server load what the job used for the next job.
+    if (daemon != NULL) {
+        daemon->report(isa_file_path, cache_dir, gena->program_files());
     }
 	return 0;
 }
 
+// Main function.
+int main(int argc, char* argv[]) {
+	std::string daemon_path;
+	std::string server_path;
+	std::vector<std::string> job_args;
+	std::vector<std::string> watch_paths;
+	bool watch = false;
+
+	// The daemon and server flags are handled first, every other argument
+	// is part of the job.
+	for (int i = 0; i < argc; i++) {
+		if ((i > 0) && (i != argc - 1) && \
+			((std::strcmp(argv[i], DAEMON_FLAG) == 0) || 
+			 (std::strcmp(argv[i], DAEMON_FLAG_SHORT) == 0))) {
+			daemon_path = argv[++i];
+			continue;
+		}
+		if ((i > 0) && (i != argc - 1) && \
+			((std::strcmp(argv[i], SERVER_FLAG) == 0) || 
+			 (std::strcmp(argv[i], SERVER_FLAG_SHORT) == 0))) {
+			server_path = argv[++i];
+			continue;
+		}
+		if ((i > 0) && ((std::strcmp(argv[i], WATCH_FLAG) == 0) || 
+						(std::strcmp(argv[i], WATCH_FLAG_SHORT) == 0))) {
+			watch = true;
+			continue;
+		}
+		// The main and ISA files are watched even if the first job fails
+		// before it reports its files.
+		if ((i > 0) && (i != argc - 1) && \
+			((std::strcmp(argv[i], FILE_FLAG) == 0) || 
+			 (std::strcmp(argv[i], FILE_FLAG_SHORT) == 0) || 
+			 (std::strcmp(argv[i], ISA_FLAG) == 0) || 
+			 (std::strcmp(argv[i], ISA_FLAG_SHORT) == 0))) {
+			watch_paths.push_back(argv[i + 1]);
+		}
+		job_args.push_back(argv[i]);
+	}
+	// Serve jobs until stopped, every job runs in its own process.
+	if (!daemon_path.empty()) {
+		server daemon(daemon_path, \
+					  std::max(1U, std::thread::hardware_concurrency()));
+		return daemon.serve([&daemon](int job_argc, char* job_argv[]) {
+			return assemble(job_argc, job_argv, &daemon);
+		}) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	// Run the job every time its files change, every run is in its own
+	// process.
+	if (watch) {
+		server watcher("", std::max(1U, std::thread::hardware_concurrency()));
+		return watcher.watch(job_args, watch_paths, \
+							 [&watcher](int job_argc, char* job_argv[]) {
+			return assemble(job_argc, job_argv, &watcher);
+		}) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	// Run the job on the server if there is one, otherwise run it here.
+	if (!server_path.empty()) {
+		int status;
+		if (server::request(server_path, job_args, status)) {
+			return status;
+		}
+	}
+	std::vector<char*> job_argv;
+	for (std::string& arg : job_args) {
+		job_argv.push_back(arg.data());
+	}
+	job_argv.push_back(NULL);
+	return assemble(job_args.size(), job_argv.data(), NULL);
+}
+
 
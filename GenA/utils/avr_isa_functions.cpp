@@ -8,9 +8,40 @@
 #include <algorithm>
 #include <cctype>
 #include <vector>
+#include <stdexcept>
+#include "gena_abi.h"
+
+// Encoders and batch encoders for every function, each wraps the function of
+// the same name followed by _bits.
+#define AVR_ENCODER(name) \
+    int name(const gena_operands* ops, uint64_t* out) { \
+        try { \
+            *out = name##_bits(ops->op_code, ops); \
+        } \
+        catch (const std::exception& e) { \
+            return GENA_ENCODE_ERROR; \
+        } \
+        return GENA_ENCODE_OK; \
+    } \
+    int name##_batch(const gena_operands* ops, size_t count, uint64_t* out) { \
+        try { \
+            for (size_t i = 0; i < count; i++) { \
+                out[i] = name##_bits(ops[i].op_code, &ops[i]); \
+            } \
+        } \
+        catch (const std::exception& e) { \
+            return GENA_ENCODE_ERROR; \
+        } \
+        return GENA_ENCODE_OK; \
+    }
 
 extern "C" {
 
+    // This library uses the binary encoder ABI.
+    uint32_t gena_abi_version(void) {
+        return GENA_ENCODER_ABI_VERSION;
+    }
+
     // Define Register Symbols used in AVR.
     const size_t XL = 26;
     const size_t XH = 27;
@@ -21,39 +52,102 @@ extern "C" {
 
     const size_t OPCODE_DEFAULT_LENGTH = 16; // Default instruction length is 16 bit
     const size_t OPCODE_EXTRA_LENGTH = 32;   // But a few instructions are 32 bit
+    // Labels and the program counter are addresses in bits, the program
+    // memory is addressed in 16 bit instruction words.
+    const size_t INSTRUCTION_WORD_BITS = 16;
 
     /**
-     * Converts the string representation of a register or value to its decimal 
-     * equivalent. For example R16 would return 16.
+     * Converts an operand of a register or value to its decimal equivalent.
+     * For example R16 would return 16.
      * 
-     * @param val the value to parse
+     * @param op the operand to parse
      * @return the decimal representation of the value.
      */
-    size_t parse_value(std::string val) {
-        if (val.empty()) {
+    size_t parse_value(const gena_operand& op) {
+        switch (op.kind) {
+            // Numbers, symbols and the program counter are already values.
+            case GENA_OPERAND_INTEGER:
+            case GENA_OPERAND_SYMBOL:
+            case GENA_OPERAND_PC:
+                return op.value;
+            default:
+                break;
+        }
+        if (op.text_len == 0) {
             return 0;
         }
-        // Convert the string to upper case.
-        std::transform(val.begin(), val.end(), val.begin(), [](unsigned char c) { return std::toupper(c); });
-        
         // Get the part of the value that contains the register designator
-        char first_char = val[0];
-        // std::cout << first_char << std::endl;
+        char first_char = std::toupper(static_cast<unsigned char>(op.text[0]));
+        char second_char = (op.text_len > 1) ? \
+                           std::toupper(static_cast<unsigned char>(op.text[1])) : 0;
         
         switch (first_char) {
             // Handle register parsing
             case 'R':
-                return std::stoi(val.substr(1));
+                if (op.kind == GENA_OPERAND_REGISTER) {
+                    return op.value;
+                }
+                throw std::invalid_argument("invalid register");
             case 'X':
-                return (val[1] == 'L') ? XL : XH;
+                return (second_char == 'L') ? XL : XH;
             case 'Y':
-                return (val[1] == 'L') ? YL : YH;
+                return (second_char == 'L') ? YL : YH;
             case 'Z':
-                return (val[1] == 'L') ? ZL : ZH;
+                return (second_char == 'L') ? ZL : ZH;
             default:
-                // Else assume the value is a literal decimal
-                return std::stoi(val);
+                throw std::invalid_argument("invalid value");
+        }
+    }
+
+    /**
+     * Returns the value of an argument. Arguments are numbered from the last
+     * operand to the first, the order the string ABI passed them in.
+     * 
+     * @param ops the operands of the instruction
+     * @param i the argument number
+     * @return the decimal representation of the argument.
+     */
+    size_t arg(const gena_operands* ops, size_t i) {
+        if (i >= ops->count) {
+            throw std::out_of_range("missing argument");
         }
+        return parse_value(ops->operands[ops->count - 1 - i]);
+    }
+
+    /**
+     * Returns the value of an argument that must be a number, a symbol or the
+     * program counter.
+     * 
+     * @param ops the operands of the instruction
+     * @param i the argument number
+     * @return the value of the argument.
+     */
+    size_t number(const gena_operands* ops, size_t i) {
+        if (i >= ops->count) {
+            throw std::out_of_range("missing argument");
+        }
+        const gena_operand& op = ops->operands[ops->count - 1 - i];
+        if ((op.kind == GENA_OPERAND_REGISTER) || \
+            (op.kind == GENA_OPERAND_NAME)) {
+            throw std::invalid_argument("not a number");
+        }
+        return op.value;
+    }
+
+    /**
+     * Returns the distance from the instruction after this one to a label in
+     * instruction words, what relative jumps and branches encode. The label
+     * and program counter are arguments that hold addresses in bits.
+     * 
+     * @param ops the operands of the instruction
+     * @param label the argument number of the label
+     * @param pc the argument number of the program counter
+     * @return the offset, to be masked to the width of the instruction.
+     */
+    size_t word_offset(const gena_operands* ops, size_t label, size_t pc) {
+        int64_t distance = static_cast<int64_t>(number(ops, label)) - \
+                           static_cast<int64_t>(number(ops, pc));
+        return distance / static_cast<int64_t>(INSTRUCTION_WORD_BITS) - 1;
     }
 
     void print_binary_with_spaces(uint16_t number) {
@@ -80,9 +174,9 @@ extern "C" {
 
     // 4 bit opcode instructions: includes ALU ops with immediates
     // general format is #### KKKK dddd KKKK
-    size_t parse_alu_imm(size_t opcode, std::vector<std::string> args) {
-        size_t immediate_toi = parse_value(args[1]);
-        size_t reg_toi = parse_value(args[0]);
+    static size_t parse_alu_imm_bits(size_t opcode, const gena_operands* args) {
+        size_t immediate_toi = arg(args, 1);
+        size_t reg_toi = arg(args, 0);
         size_t opcode_bit_length = 4;
         size_t opcode_shifted = (opcode) << (OPCODE_DEFAULT_LENGTH - opcode_bit_length);
         size_t immediate_first_byte = ((immediate_toi >> 4)) << 8;
@@ -92,17 +186,17 @@ extern "C" {
     }
 
     // Some ALU ops with 1 bit.
-    size_t parse_alu_1(size_t opcode, std::vector<std::string> args) {
-        size_t reg_d_toi = parse_value(args[0]) & 0b111111;
+    static size_t parse_alu_1_bits(size_t opcode, const gena_operands* args) {
+        size_t reg_d_toi = arg(args, 0) & 0b111111;
         size_t opcode_bit_length = 6;
         size_t opcode_shifted = opcode << (OPCODE_DEFAULT_LENGTH - opcode_bit_length);
         return opcode_shifted | reg_d_toi;
     }
 
     // Some ALU operations with 2 inputs, format is #### ##rd dddd rrrr
-    size_t parse_alu_2(size_t opcode, std::vector<std::string> args) {
-        size_t reg_d_toi = parse_value(args[0]);
-        size_t reg_r_toi = parse_value(args[1]);
+    static size_t parse_alu_2_bits(size_t opcode, const gena_operands* args) {
+        size_t reg_d_toi = arg(args, 0);
+        size_t reg_r_toi = arg(args, 1);
         size_t opcode_bit_length = 6;
         size_t opcode_shifted = opcode << (OPCODE_DEFAULT_LENGTH - opcode_bit_length);
         size_t reg_r_first_bit_shifted = (reg_r_toi >> 4) << 9;
@@ -114,14 +208,13 @@ extern "C" {
     }
 
     // Full length instructions. op code is #### #### #### #####
-    size_t parse_full_length(size_t opcode, std::vector<std::string>) {
+    static size_t parse_full_length_bits(size_t opcode, const gena_operands*) {
         return opcode;
     }
 
     // Branch instructions except BRBC/BRBS, format is #### ##kk kkkk k###
-    size_t parse_branch(size_t opcode, std::vector<std::string> args) {
-        size_t label_toi = parse_value(args[0]) & 0b1111111;
-        size_t offset = label_toi - std::stoul(args[1]);
+    static size_t parse_branch_bits(size_t opcode, const gena_operands* args) {
+        size_t offset = word_offset(args, 1, 0);
         size_t opcode_bit_length = 9;
         size_t opcode_first_6_shifted = (opcode >> (opcode_bit_length - 6)) << (OPCODE_DEFAULT_LENGTH - 6);
         size_t opcode_last_3 = opcode & 0b111;
@@ -130,18 +223,17 @@ extern "C" {
     }
 
     // Branch instructions for BRBC/BRBS
-    size_t parse_branch_with_bit(size_t opcode, std::vector<std::string> args) {
-        size_t label_toi = parse_value(args[0]) & 0b1111111;
-        size_t offset = label_toi - std::stoul(args[2]);
-        size_t sreg_bit_toi = parse_value(args[1]) & 0b111;
+    static size_t parse_branch_with_bit_bits(size_t opcode, const gena_operands* args) {
+        size_t offset = word_offset(args, 1, 0);
+        size_t sreg_bit_toi = arg(args, 2) & 0b111;
         size_t opcode_shifted = opcode << (OPCODE_DEFAULT_LENGTH - 6);
         size_t offset_shifted = (offset & 0b1111111) << 3;
         return opcode_shifted | offset_shifted | sreg_bit_toi;
     }
 
     // Some ALU and LD/ST instructions. Format is #### ###d dddd ####
-    size_t parse_ld_st_stck_alu(size_t opcode, std::vector<std::string> args) {
-        size_t reg_toi = parse_value(args[0]);
+    static size_t parse_ld_st_stck_alu_bits(size_t opcode, const gena_operands* args) {
+        size_t reg_toi = arg(args, 0);
         size_t opcode_bit_length = 11;
         size_t opcode_first7_shifted = (opcode >> (opcode_bit_length - 7)) << (OPCODE_DEFAULT_LENGTH - 7);
         size_t opcode_last4 = opcode & 0b1111;
@@ -151,9 +243,9 @@ extern "C" {
 
     // Most multiplication. Format is #### #### #ddd #rrr except MULS
     // Default opcode format is #### #### dddd ####  
-    size_t parse_mul(size_t opcode, std::vector<std::string> args) {
-        size_t reg_d_toi = parse_value(args[0]);
-        size_t reg_r_toi = parse_value(args[1]);
+    static size_t parse_mul_bits(size_t opcode, const gena_operands* args) {
+        size_t reg_d_toi = arg(args, 0);
+        size_t reg_r_toi = arg(args, 1);
         
         switch (opcode) {
             // MULS is 12 bit long instruction and different format
@@ -178,15 +270,15 @@ extern "C" {
     }
 
     // I/O instructions, format is #### #AAd dddd AAAA
-    size_t parse_io(size_t opcode, std::vector<std::string> args) {
+    static size_t parse_io_bits(size_t opcode, const gena_operands* args) {
         size_t reg_toi;
         size_t port_toi;
         if (opcode == 22) {
-            reg_toi = parse_value(args[0]) & 0b11111;
-            port_toi = parse_value(args[1]) & 0b11111;
+            reg_toi = arg(args, 0) & 0b11111;
+            port_toi = arg(args, 1) & 0b11111;
         } else {
-            reg_toi = parse_value(args[1]) & 0b11111;
-            port_toi = parse_value(args[0]) & 0b11111;
+            reg_toi = arg(args, 1) & 0b11111;
+            port_toi = arg(args, 0) & 0b11111;
         }
         size_t opcode_bit_length = 5;
         size_t opcode_shifted = opcode << (OPCODE_DEFAULT_LENGTH - opcode_bit_length);
@@ -197,8 +289,8 @@ extern "C" {
     }
 
     // DES and SER instruction
-    size_t parse_des_ser(size_t opcode, std::vector<std::string> args) {
-        size_t val_toi = parse_value(args[0]) & 0b1111;
+    static size_t parse_des_ser_bits(size_t opcode, const gena_operands* args) {
+        size_t val_toi = arg(args, 0) & 0b1111;
         size_t val_shifted = val_toi << 4;
         size_t opcode_first_8_shifted = (opcode >> 4) << (OPCODE_DEFAULT_LENGTH - 8);
         size_t opcode_last_4 = opcode & 0b1111; 
@@ -206,8 +298,8 @@ extern "C" {
     }
 
     // BCLR/BSET
-    size_t parse_modify_flags(size_t opcode, std::vector<std::string> args) {
-        size_t flag_bit_toi = parse_value(args[0]) & 0b111;
+    static size_t parse_modify_flags_bits(size_t opcode, const gena_operands* args) {
+        size_t flag_bit_toi = arg(args, 0) & 0b111;
         size_t flag_bit_shifted = flag_bit_toi << 4;
         size_t opcode_first_9_shifted = (opcode >> 4) << (OPCODE_DEFAULT_LENGTH - 9);
         size_t opcode_last_4 = opcode & 0b1111;
@@ -215,9 +307,9 @@ extern "C" {
     }
 
     // SBRC/SBRS and BLD/BST
-    size_t parse_bit_check_load_store(size_t opcode, std::vector<std::string> args) {
-        size_t val_toi = parse_value(args[0]) & 0b1111;
-        size_t bit_toi = parse_value(args[1]) & 0b111;
+    static size_t parse_bit_check_load_store_bits(size_t opcode, const gena_operands* args) {
+        size_t val_toi = arg(args, 0) & 0b1111;
+        size_t bit_toi = arg(args, 1) & 0b111;
         size_t opcode_first_7_shifted = opcode << (OPCODE_DEFAULT_LENGTH - 7);
         size_t opcode_last_shifted = (opcode & 0b1) << 3;
         size_t val_shifted = val_toi << 8;
@@ -225,9 +317,9 @@ extern "C" {
     }
 
     // SBI
-    size_t parse_clear_set_bit(size_t opcode, std::vector<std::string> args) {
-        size_t io_reg_toi = parse_value(args[0]) & 0b11111;
-        size_t bit_toi = parse_value(args[1]) & 0b111;
+    static size_t parse_clear_set_bit_bits(size_t opcode, const gena_operands* args) {
+        size_t io_reg_toi = arg(args, 0) & 0b11111;
+        size_t bit_toi = arg(args, 1) & 0b111;
         size_t opcode_length = 8;
         size_t opcode_shifted = opcode << (OPCODE_DEFAULT_LENGTH - opcode_length);
         size_t io_reg_shifted = io_reg_toi << 7;
@@ -235,15 +327,15 @@ extern "C" {
     }
 
     // 32 bit LDS and STS
-    size_t parse_load_store_32(size_t opcode, std::vector<std::string> args) {
+    static size_t parse_load_store_32_bits(size_t opcode, const gena_operands* args) {
         size_t reg_toi;
         size_t imm_toi;
         if (opcode == 1152) {
-            reg_toi = parse_value(args[0]) & 0b11111;
-            imm_toi = parse_value(args[1]) & 0xFFFF;
+            reg_toi = arg(args, 0) & 0b11111;
+            imm_toi = arg(args, 1) & 0xFFFF;
         } else {
-            reg_toi = parse_value(args[1]) & 0b11111;
-            imm_toi = parse_value(args[0]) & 0xFFFF;
+            reg_toi = arg(args, 1) & 0b11111;
+            imm_toi = arg(args, 0) & 0xFFFF;
         }
         size_t opcode_first_7_shifted = (opcode >> 4) << (OPCODE_EXTRA_LENGTH - 7);
         size_t opcode_last_4_shifted = (opcode & 0b1111) << (OPCODE_DEFAULT_LENGTH);
@@ -251,17 +343,17 @@ extern "C" {
         return opcode_first_7_shifted | reg_toi_shifted | opcode_last_4_shifted | imm_toi;
     }
 
-    size_t parse_load_store_16(size_t opcode, std::vector<std::string> args) {
+    static size_t parse_load_store_16_bits(size_t opcode, const gena_operands* args) {
         size_t reg_toi;
         size_t imm_toi;
         size_t opcode_length = 5;
         size_t data = 0;
         if (opcode == 21 || opcode > 17) {
-            reg_toi = parse_value(args[1]) & 0b1111;
-            imm_toi = parse_value(args[0]) & 0b111111;
+            reg_toi = arg(args, 1) & 0b1111;
+            imm_toi = arg(args, 0) & 0b111111;
         } else {
-            reg_toi = parse_value(args[0]) & 0b1111;
-            imm_toi = parse_value(args[1]) & 0b111111;
+            reg_toi = arg(args, 0) & 0b1111;
+            imm_toi = arg(args, 1) & 0b111111;
         }
         if (opcode >= 20) {
             size_t opcode_shifted = opcode << (OPCODE_DEFAULT_LENGTH - opcode_length);
@@ -285,9 +377,9 @@ extern "C" {
     }
 
     // ADIW, SUBIW
-    size_t parse_add_sub_word(size_t opcode, std::vector<std::string> args) {
-        size_t reg_toi = parse_value(args[0]);
-        size_t word_toi = parse_value(args[1]);
+    static size_t parse_add_sub_word_bits(size_t opcode, const gena_operands* args) {
+        size_t reg_toi = arg(args, 0);
+        size_t word_toi = arg(args, 1);
         size_t opcode_length = 8;
         size_t opcode_shifted = opcode << (OPCODE_DEFAULT_LENGTH - opcode_length);
         size_t reg_as_two_bits_shifted = (((reg_toi - 24) / 2) & 0b11) << 4;
@@ -297,9 +389,9 @@ extern "C" {
     }
 
     // MOVW
-    size_t parse_mov_word(size_t opcode, std::vector<std::string> args) {
-        size_t reg_d_toi = parse_value(args[0]) & 0b1111;
-        size_t reg_r_toi = parse_value(args[1]) & 0b1111;
+    static size_t parse_mov_word_bits(size_t opcode, const gena_operands* args) {
+        size_t reg_d_toi = arg(args, 0) & 0b1111;
+        size_t reg_r_toi = arg(args, 1) & 0b1111;
         size_t opcode_length = 8;
         size_t opcode_shifted = opcode << (OPCODE_DEFAULT_LENGTH - opcode_length);
         size_t reg_d_shifted = reg_d_toi << 4;
@@ -307,21 +399,40 @@ extern "C" {
     }
 
     // Relative jump and call
-    size_t parse_rcall_rjmp(size_t opcode, std::vector<std::string> args) {
+    static size_t parse_rcall_rjmp_bits(size_t opcode, const gena_operands* args) {
         size_t opcode_length = 4;
         size_t opcode_shifted = opcode << (OPCODE_DEFAULT_LENGTH - opcode_length);
-        size_t label_toi = parse_value(args[0]) & 0xFFF;
-        size_t offset = (label_toi - std::stoul(args[1])) & 0xFFF;
+        size_t offset = word_offset(args, 1, 0) & 0xFFF;
         return opcode_shifted | offset;
     }
 
     // Format #### ###k kkkk ###k kkkk kkkk kkkk kkkk
-    size_t parse_call_jmp(size_t opcode, std::vector<std::string> args) {
-        size_t label_toi = parse_value(args[0]);
+    static size_t parse_call_jmp_bits(size_t opcode, const gena_operands* args) {
+        size_t label_toi = number(args, 1) / INSTRUCTION_WORD_BITS;
         size_t opcode_first_7 = (opcode >> 3) << (OPCODE_EXTRA_LENGTH - 7);
         size_t opcode_last_3_shifted = (opcode & 0b111) << (OPCODE_EXTRA_LENGTH - 15);
-        size_t label_first_5_shifted = (label_toi >> 17);
+        size_t label_first_5_shifted = ((label_toi >> 17) & 0b11111) << 20;
         size_t label_last_17 = label_toi & 0x1FFFF;
         return opcode_first_7 | label_first_5_shifted | opcode_last_3_shifted | label_last_17;
     }
+
+    AVR_ENCODER(parse_alu_imm)
+    AVR_ENCODER(parse_alu_1)
+    AVR_ENCODER(parse_alu_2)
+    AVR_ENCODER(parse_full_length)
+    AVR_ENCODER(parse_branch)
+    AVR_ENCODER(parse_branch_with_bit)
+    AVR_ENCODER(parse_ld_st_stck_alu)
+    AVR_ENCODER(parse_mul)
+    AVR_ENCODER(parse_io)
+    AVR_ENCODER(parse_des_ser)
+    AVR_ENCODER(parse_modify_flags)
+    AVR_ENCODER(parse_bit_check_load_store)
+    AVR_ENCODER(parse_clear_set_bit)
+    AVR_ENCODER(parse_load_store_32)
+    AVR_ENCODER(parse_load_store_16)
+    AVR_ENCODER(parse_add_sub_word)
+    AVR_ENCODER(parse_mov_word)
+    AVR_ENCODER(parse_rcall_rjmp)
+    AVR_ENCODER(parse_call_jmp)
 }
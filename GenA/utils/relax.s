@@ -0,0 +1,25 @@
+; Jumps and calls for --relax. JMP and CALL become RJMP and RCALL when
+; their target is -4094 to 4096 bytes from the start of the line.
+start: NOP ;
+NOP ;
+JMP fwd
+RJMP fwd
+NOP ;
+fwd: NOP ;
+BREQ start
+CALL fwd
+RJMP start
+
+; Listing without --relax, address and instruction:
+;   00004 940c0006  JMP fwd
+;   00008 0c001     RJMP fwd
+;   0000e 0f3c1     BREQ start
+;   00010 940e0006  CALL fwd
+;   00014 0cff5     RJMP start
+;
+; Listing with --relax:
+;   00004 0c002     JMP fwd
+;   00006 0c001     RJMP fwd
+;   0000c 0f3c9     BREQ start
+;   0000e 0dffd     CALL fwd
+;   00010 0cff7     RJMP start